@@ -1,11 +1,71 @@
+#include <charconv>
+#include <cstdlib>
+#include <ctime>
+#include <iomanip>
 #include <iostream>
+#include <sstream>
+#include <string>
 //App Headers
 #include "Core/Api/Session.hpp"
 
+constexpr long long LATEST_TIME = 253402300799; // 9999-12-31, in seconds, milliseconds still fit
+
+// Seconds since epoch, or a local YYYY-MM-DDTHH:MM, -1 when neither
+long long parseTime(const std::string& text) {
+    if (text.empty()) return -1;
+
+    if (text.find_first_not_of("0123456789") == std::string::npos) {
+        long long seconds = -1;
+        auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), seconds);
+        bool parsed = error == std::errc() && end == text.data() + text.size();
+        return parsed && seconds <= LATEST_TIME ? seconds : -1;
+    }
+    std::tm tm = {};
+    std::istringstream stream(text);
+    stream >> std::get_time(&tm, "%Y-%m-%dT%H:%M");
+    if (stream.fail()) return -1;
+    tm.tm_isdst = -1;
+    return std::mktime(&tm);
+}
+
 int main(int argc, const char * argv[]) {
+    // --playback <from> <to> [speed] [timeframe] replays the stored history of the range on the panel
+    if (argc > 1 && std::string(argv[1]) == "--playback") {
+        long long from = argc > 3 ? parseTime(argv[2]) : -1;
+        long long to = argc > 3 ? parseTime(argv[3]) : -1;
+        double speed = argc > 4 ? std::atof(argv[4]) : 60.0;
+        if (from < 0 || to <= from || speed <= 0) {
+            std::cerr << "Usage: --playback <from> <to> [speed] [timeframe], times as YYYY-MM-DDTHH:MM or seconds since epoch" << std::endl;
+            return 1;
+        }
+
+        Clock::getInstance()->simulate(from * 1000);
+        auto s = std::make_shared<Session>();
+        s->runPlayback(from, to, speed, argc > 5 ? argv[5] : "");
+        return 0;
+    }
+
+    // --simulate [script] replays a scripted day, or a generated one for the watchlist, on a simulated clock
+    if (argc > 1 && std::string(argv[1]) == "--simulate") {
+        SimulationScript script;
+        if (argc > 2) {
+            if (!script.load(argv[2])) return 1;
+        } else {
+            script.generate(Config::getInstance(CONFIG_FILE)->getApiSubsList(), SIMULATION_DEFAULT_START, SIMULATION_DEFAULT_LENGTH, 1);
+        }
+        if (script.trades().empty()) {
+            std::cerr << "Nothing to simulate, the watchlist is empty" << std::endl;
+            return 1;
+        }
+
+        // before the session exists, every component reads the simulated clock from the start
+        Clock::getInstance()->simulate(script.start());
+        auto s = std::make_shared<Session>();
+        return s->runSimulation(script) ? 0 : 1;
+    }
+
     auto s = std::make_shared<Session>();
-    s->chooseConfigAndSubscribe();
     s->runForever();
     
     return 0;
-}
\ No newline at end of file
+}
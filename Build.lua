@@ -26,3 +26,5 @@ group "Core"
 group ""
 
 include "App/Build-App.lua"
+include "Daemon/Build-Daemon.lua"
+include "Tests/Build-Tests.lua"
@@ -29,7 +29,7 @@ project "Core"
        defines { }
 
    filter "configurations:Debug"
-       defines { "DEBUG" }
+       defines { "DEBUG", "ALLOCATION_AUDIT" }
        runtime "Debug"
        symbols "On"
 
@@ -0,0 +1,351 @@
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <poll.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <iostream>
+#include "FeedBus.hpp"
+#include "Core/Api/FeedManager.hpp"
+
+namespace {
+    bool fillAddress(sockaddr_un& address, const std::string& path) {
+        if (path.size() >= sizeof(address.sun_path)) {
+            std::cerr << "Feed bus socket path is too long: " << path << std::endl;
+            return false;
+        }
+        std::memset(&address, 0, sizeof(address));
+        address.sun_family = AF_UNIX;
+        std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+        return true;
+    }
+}
+
+bool makeFeedBusMessage(FeedBusMessage& message, FeedBusType type, std::string_view symbol,
+                        double price, long long time) {
+    if (symbol.size() > FEED_BUS_SYMBOL_SIZE) return false;
+
+    std::memset(&message, 0, sizeof(message));
+    message.type = type;
+    message.symbolLength = static_cast<uint8_t>(symbol.size());
+    message.time = time;
+    message.price = price;
+    std::memcpy(message.symbol, symbol.data(), symbol.size());
+    return true;
+}
+
+std::string_view feedBusSymbol(const FeedBusMessage& message) {
+    return std::string_view(message.symbol, std::min<size_t>(message.symbolLength, FEED_BUS_SYMBOL_SIZE));
+}
+
+FeedBusServer::~FeedBusServer() {
+    close();
+}
+
+bool FeedBusServer::open(const std::string& path) {
+    sockaddr_un address;
+    if (!fillAddress(address, path)) return false;
+
+    listenFd_ = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (listenFd_ < 0) {
+        std::cerr << "Could not create the feed bus socket: " << strerror(errno) << std::endl;
+        return false;
+    }
+
+    // a socket file left behind by a daemon that did not shut down cleanly
+    unlink(path.c_str());
+    if (bind(listenFd_, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 ||
+        listen(listenFd_, FEED_BUS_BACKLOG) != 0) {
+        std::cerr << "Could not listen on " << path << ": " << strerror(errno) << std::endl;
+        ::close(listenFd_);
+        listenFd_ = -1;
+        return false;
+    }
+
+    path_ = path;
+    std::cout << "Feed bus listening on " << path_ << std::endl;
+    return true;
+}
+
+void FeedBusServer::close() {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    for (int fd : clients_) {
+        ::close(fd);
+    }
+    clients_.clear();
+    subscribers_.clear();
+
+    if (listenFd_ >= 0) {
+        ::close(listenFd_);
+        unlink(path_.c_str());
+        listenFd_ = -1;
+    }
+}
+
+bool FeedBusServer::poll(std::chrono::milliseconds timeout) {
+    std::vector<pollfd> fds;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        fds.push_back({listenFd_, POLLIN, 0});
+        for (int fd : clients_) {
+            fds.push_back({fd, POLLIN, 0});
+        }
+    }
+
+    // the client list only changes on this thread, publishers just read it
+    if (::poll(fds.data(), fds.size(), timeout.count()) <= 0) return false;
+
+    bool changed = false;
+    for (size_t i = 1; i < fds.size(); i += 1) {
+        if (fds[i].revents & (POLLIN | POLLHUP | POLLERR)) {
+            changed = read(fds[i].fd) || changed;
+        }
+    }
+    if (fds[0].revents & POLLIN) {
+        accept();
+    }
+    return changed;
+}
+
+void FeedBusServer::accept() {
+    while (true) {
+        int fd = ::accept4(listenFd_, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) return;
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        clients_.push_back(fd);
+        std::cout << "Feed bus client connected, " << clients_.size() << " clients" << std::endl;
+    }
+}
+
+bool FeedBusServer::read(int fd) {
+    bool changed = false;
+    FeedBusMessage message;
+    while (true) {
+        ssize_t received = recv(fd, &message, sizeof(message), MSG_DONTWAIT);
+        if (received < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) return changed;
+        if (received <= 0) return disconnect(fd) || changed;
+        if (received != sizeof(message)) continue;
+
+        std::string apiSymbol(feedBusSymbol(message));
+        if (message.type == FeedBusType::Subscribe) {
+            changed = subscribe(fd, apiSymbol) || changed;
+        } else if (message.type == FeedBusType::Unsubscribe) {
+            changed = unsubscribe(fd, apiSymbol) || changed;
+        }
+    }
+}
+
+bool FeedBusServer::subscribe(int fd, const std::string& apiSymbol) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    auto& subscribers = subscribers_[apiSymbol];
+    if (std::find(subscribers.begin(), subscribers.end(), fd) != subscribers.end()) return false;
+    subscribers.push_back(fd);
+    return subscribers.size() == 1;
+}
+
+bool FeedBusServer::unsubscribe(int fd, const std::string& apiSymbol) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    auto it = subscribers_.find(apiSymbol);
+    if (it == subscribers_.end()) return false;
+
+    std::erase(it->second, fd);
+    if (!it->second.empty()) return false;
+    subscribers_.erase(it);
+    return true;
+}
+
+bool FeedBusServer::disconnect(int fd) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    bool changed = false;
+    for (auto it = subscribers_.begin(); it != subscribers_.end();) {
+        std::erase(it->second, fd);
+        if (it->second.empty()) {
+            it = subscribers_.erase(it);
+            changed = true;
+        } else {
+            ++it;
+        }
+    }
+
+    std::erase(clients_, fd);
+    ::close(fd);
+    std::cout << "Feed bus client disconnected, " << clients_.size() << " clients" << std::endl;
+    return changed;
+}
+
+std::vector<std::string> FeedBusServer::subscriptions() {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    std::vector<std::string> apiSymbols;
+    for (const auto& [apiSymbol, subscribers] : subscribers_) {
+        apiSymbols.push_back(apiSymbol);
+    }
+    std::sort(apiSymbols.begin(), apiSymbols.end());
+    return apiSymbols;
+}
+
+void FeedBusServer::publish(const std::string& apiSymbol, const FeedBusMessage& message) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    auto it = subscribers_.find(apiSymbol);
+    if (it == subscribers_.end()) return;
+
+    for (int fd : it->second) {
+        // a full socket buffer means a stalled display, it misses this message
+        if (send(fd, &message, sizeof(message), MSG_DONTWAIT | MSG_NOSIGNAL) == sizeof(message)) {
+            sent_ += 1;
+        } else {
+            dropped_ += 1;
+        }
+    }
+}
+
+void FeedBusServer::reportCheck() {
+    auto now = std::chrono::steady_clock::now();
+    if (now < nextReportTime_) return;
+    nextReportTime_ = now + std::chrono::seconds(FEED_BUS_REPORT_TIME);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::cout << "Feed bus clients: " << clients_.size()
+              << ", symbols: " << subscribers_.size()
+              << ", messages sent: " << sent_
+              << ", dropped: " << dropped_ << std::endl;
+    sent_ = 0;
+    dropped_ = 0;
+}
+
+FeedBusClient::FeedBusClient(const std::string& path, MessageHandler handler)
+    : path_(path), handler_(std::move(handler)) {
+    reader_ = std::thread(&FeedBusClient::readLoop, this);
+}
+
+FeedBusClient::~FeedBusClient() {
+    close();
+}
+
+void FeedBusClient::setSymbols(const std::vector<std::string>& apiSymbols) {
+    std::vector<std::string> addedSymbols = symbolsMissingFrom(apiSymbols, apiSymbols_);
+    std::vector<std::string> removedSymbols = symbolsMissingFrom(apiSymbols_, apiSymbols);
+    apiSymbols_ = apiSymbols;
+
+    std::cout << "Feed bus subscriptions added: " << addedSymbols.size() << ", removed: " << removedSymbols.size() << std::endl;
+    for (const auto& symbol : removedSymbols) {
+        send(FeedBusType::Unsubscribe, symbol);
+    }
+    for (const auto& symbol : addedSymbols) {
+        send(FeedBusType::Subscribe, symbol);
+    }
+}
+
+void FeedBusClient::check() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (fd_ >= 0) return;
+    }
+
+    auto now = std::chrono::steady_clock::now();
+    if (!backoff_.ready(now)) return;
+
+    if (!connect()) {
+        auto delay = backoff_.failed(now);
+        std::cout << "Retrying the feed daemon in " << delay.count() << "ms" << std::endl;
+        return;
+    }
+    backoff_.succeeded();
+
+    // the daemon forgets a client's symbols with its connection
+    for (const auto& symbol : apiSymbols_) {
+        send(FeedBusType::Subscribe, symbol);
+    }
+}
+
+void FeedBusClient::close() {
+    stopping_ = true;
+    if (reader_.joinable()) {
+        reader_.join();
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (fd_ >= 0) {
+        ::close(fd_);
+        fd_ = -1;
+    }
+}
+
+bool FeedBusClient::takeReconnected() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    bool reconnected = reconnected_;
+    reconnected_ = false;
+    return reconnected;
+}
+
+bool FeedBusClient::connect() {
+    sockaddr_un address;
+    if (!fillAddress(address, path_)) return false;
+
+    int fd = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+    if (fd < 0) return false;
+    if (::connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+        std::cerr << "Could not connect to the feed daemon at " << path_ << ": " << strerror(errno) << std::endl;
+        ::close(fd);
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    fd_ = fd;
+    reconnected_ = connectedBefore_;
+    connectedBefore_ = true;
+    std::cout << "Connected to the feed daemon at " << path_ << std::endl;
+    return true;
+}
+
+void FeedBusClient::send(FeedBusType type, const std::string& apiSymbol) {
+    FeedBusMessage message;
+    if (!makeFeedBusMessage(message, type, apiSymbol, 0, 0)) {
+        std::cerr << "Symbol too long for the feed bus: " << apiSymbol << std::endl;
+        return;
+    }
+
+    // requests are tiny and rare, a lost connection is resubscribed by check()
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (fd_ >= 0) {
+        ::send(fd_, &message, sizeof(message), MSG_NOSIGNAL);
+    }
+}
+
+void FeedBusClient::readLoop() {
+    FeedBusMessage message;
+    while (!stopping_) {
+        int fd;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            fd = fd_;
+        }
+        if (fd < 0) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(NETWORK_CHECK_TIME));
+            continue;
+        }
+
+        pollfd readable{fd, POLLIN, 0};
+        if (::poll(&readable, 1, NETWORK_CHECK_TIME) <= 0) continue;
+
+        ssize_t received = recv(fd, &message, sizeof(message), 0);
+        if (received == sizeof(message)) {
+            handler_(message);
+            continue;
+        }
+        if (received > 0 || (received < 0 && errno == EINTR)) continue;
+
+        std::cout << "Lost the connection to the feed daemon" << std::endl;
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (fd_ == fd) {
+            ::close(fd_);
+            fd_ = -1;
+        }
+    }
+}
@@ -0,0 +1,134 @@
+#ifndef FEED_BUS_HPP
+#define FEED_BUS_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "Core/Api/FeedConnection.hpp"
+#include "Core/GlobalParams.hpp"
+
+const std::string FEED_BUS_DEFAULT_SOCKET = "/tmp/tickerbox-feed.sock";
+
+constexpr size_t FEED_BUS_SYMBOL_SIZE = 40;
+constexpr int FEED_BUS_BACKLOG = 16;
+constexpr int FEED_BUS_REPORT_TIME = 60; // in seconds
+
+// Everything on the bus is one fixed-size message, sent as one datagram of a
+// SOCK_SEQPACKET Unix socket, so both sides read it straight into the struct.
+// Symbols are api symbols, <provider>@<symbol> for secondary providers.
+enum class FeedBusType : uint8_t {
+    Subscribe = 1,     // display -> daemon
+    Unsubscribe = 2,   // display -> daemon
+    Tick = 3,          // daemon -> display, every trade
+    Bar = 4,           // daemon -> display, the stored price once per PRICE_TIME_INTERVAL
+};
+
+struct FeedBusMessage {
+    FeedBusType type;
+    uint8_t symbolLength;
+    uint8_t reserved[6];
+    int64_t time;                        // seconds since epoch
+    double price;                        // MISSING_PRICE in a bar without any trade yet
+    char symbol[FEED_BUS_SYMBOL_SIZE];   // not terminated
+};
+static_assert(sizeof(FeedBusMessage) == 64, "the bus message layout is fixed");
+
+// Returns false for symbols that do not fit into a message.
+bool makeFeedBusMessage(FeedBusMessage& message, FeedBusType type, std::string_view symbol,
+                        double price, long long time);
+std::string_view feedBusSymbol(const FeedBusMessage& message);
+
+// Daemon side: accepts display processes and multicasts ticks and bars to
+// the ones subscribed to a symbol. A display that cannot keep up loses
+// messages instead of slowing the daemon down.
+class FeedBusServer {
+public:
+    FeedBusServer() = default;
+    ~FeedBusServer();
+
+    bool open(const std::string& path);
+    void close();
+
+    // Accepts clients and reads their requests, waiting at most timeout.
+    // Returns true when the union of all subscriptions changed.
+    bool poll(std::chrono::milliseconds timeout);
+    std::vector<std::string> subscriptions();
+
+    // Any thread, sent to the clients subscribed to apiSymbol.
+    void publish(const std::string& apiSymbol, const FeedBusMessage& message);
+
+    void reportCheck();
+
+private:
+    FeedBusServer(const FeedBusServer&);
+    FeedBusServer& operator=(const FeedBusServer&);
+
+    void accept();
+    bool read(int fd);
+    bool subscribe(int fd, const std::string& apiSymbol);
+    bool unsubscribe(int fd, const std::string& apiSymbol);
+    bool disconnect(int fd);
+
+    std::string path_;
+    int listenFd_ = -1;
+
+    std::vector<int> clients_;
+    std::unordered_map<std::string, std::vector<int>> subscribers_;   // api symbol -> client sockets
+    std::mutex mutex_;
+
+    long long sent_ = 0;
+    long long dropped_ = 0;
+    std::chrono::steady_clock::time_point nextReportTime_ = std::chrono::steady_clock::now();
+};
+
+// Display side: subscribes to the daemon instead of the providers and hands
+// every message to the handler on its own reader thread.
+class FeedBusClient {
+public:
+    using MessageHandler = std::function<void(const FeedBusMessage&)>;
+
+    FeedBusClient(const std::string& path, MessageHandler handler);
+    ~FeedBusClient();
+
+    // Called by the owning thread, like check().
+    void setSymbols(const std::vector<std::string>& apiSymbols);
+    // Reconnects a lost daemon connection with backoff and resubscribes.
+    void check();
+    void close();
+
+    // True once after the connection was lost and established again,
+    // the bars sent in between are missing from the charts.
+    bool takeReconnected();
+
+private:
+    FeedBusClient(const FeedBusClient&);
+    FeedBusClient& operator=(const FeedBusClient&);
+
+    void readLoop();
+    bool connect();
+    void send(FeedBusType type, const std::string& apiSymbol);
+
+    std::string path_;
+    MessageHandler handler_;
+
+    std::vector<std::string> apiSymbols_;
+    int fd_ = -1;
+    bool connectedBefore_ = false;
+    bool reconnected_ = false;
+    std::mutex mutex_;
+
+    ReconnectBackoff backoff_{std::chrono::milliseconds(RECONNECT_BASE_DELAY), std::chrono::milliseconds(RECONNECT_MAX_DELAY)};
+
+    std::atomic<bool> stopping_ = false;
+    std::thread reader_;
+};
+
+#endif // FEED_BUS_HPP
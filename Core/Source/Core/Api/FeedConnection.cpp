@@ -0,0 +1,290 @@
+#include <algorithm>
+#include <ctime>
+#include <iostream>
+#include "FeedConnection.hpp"
+#include "Core/System/AllocationAudit.hpp"
+
+FeedConnection::FeedConnection(std::shared_ptr<const MarketDataProvider> provider, const std::string& name, TickHandler handler)
+    : provider_(std::move(provider)), name_(name), handler_(std::move(handler)) {}
+
+void FeedConnection::open(const std::vector<std::string>& symbols) {
+    std::cout << "Creating new " << name_ << " client..." << std::endl;
+    {
+        std::lock_guard<std::mutex> lock(symbolsMutex_);
+        symbols_ = std::set<std::string>(symbols.begin(), symbols.end());
+    }
+    state_ = State::Connecting;
+    openedAt_ = time(nullptr);
+    lastTradeTime_ = time(nullptr);
+
+    client_ = std::make_unique<websocket_callback_client>();
+
+    std::weak_ptr<FeedConnection> weakSelf = shared_from_this();
+    client_->set_message_handler([weakSelf](websocket_incoming_message msg) {
+        auto self = weakSelf.lock();
+        if (!self) return;
+
+        // an older trade must never overwrite a newer price, each message waits for the one before it
+        auto body = msg.extract_string();
+        std::lock_guard<std::mutex> lock(self->messagesMutex_);
+        if (self->pendingMessages_ >= FEED_MAX_PENDING_MESSAGES) {
+            // the body of a received message is complete, parsing it here holds up the socket
+            self->coalesce(body.get());
+            return;
+        }
+        self->pendingMessages_ += 1;
+        self->lastMessage_ = self->lastMessage_.then([weakSelf, body](pplx::task<void>) {
+            auto self = weakSelf.lock();
+            if (!self) return;
+
+            try {
+                self->onMessage(body.get());
+            } catch (const std::exception& e) {
+                std::cerr << "Exception occurred: " << e.what() << std::endl;
+            }
+            self->pendingMessages_ -= 1;
+        });
+    });
+
+    client_->set_close_handler([weakSelf](websocket_close_status closeStatus, const utility::string_t& reason, const std::error_code& error) {
+        auto self = weakSelf.lock();
+        if (!self) return;
+
+        if (!reason.empty()) {
+            std::cout << "WebSocket " << self->name_ << " Closed: " << reason << std::endl;
+        } else {
+            std::cout << "WebSocket " << self->name_ << " Closed with no reason provided." << std::endl;
+        }
+        self->state_ = State::Failed;
+    });
+
+    auto self = shared_from_this();
+    client_->connect(U(provider_->url())).then([self](pplx::task<void> connected) {
+        try {
+            connected.get();
+        } catch (const std::exception& e) {
+            std::cerr << "Exception occurred: " << e.what() << std::endl;
+            self->state_ = State::Failed;
+            return;
+        }
+
+        std::cout << "Subscribing " << self->name_ << " to symbols..." << std::endl;
+        self->state_ = State::Connected;
+
+        // symbols may have been added or removed while connecting
+        std::set<std::string> symbols;
+        {
+            std::lock_guard<std::mutex> lock(self->symbolsMutex_);
+            symbols = self->symbols_;
+        }
+        for (const auto& symbol : symbols) {
+            self->send(self->provider_->subscribeMessage(symbol));
+        }
+    });
+}
+
+void FeedConnection::close() {
+    std::cout << "Closing the " << name_ << " client connection..." << std::endl;
+    state_ = State::Failed;
+
+    if (client_) {
+        // the connection stays alive until the close handshake has finished
+        auto self = shared_from_this();
+        client_->close().then([self](pplx::task<void> closed) {
+            try {
+                closed.get();
+                std::cout << "Closed the " << self->name_ << " client connection..." << std::endl;
+            } catch (const std::exception& e) {
+                std::cerr << "Exception occurred: " << e.what() << std::endl;
+            }
+        });
+    }
+}
+
+void FeedConnection::subscribe(const std::string& symbol) {
+    {
+        std::lock_guard<std::mutex> lock(symbolsMutex_);
+        symbols_.insert(symbol);
+    }
+    send(provider_->subscribeMessage(symbol));
+}
+
+void FeedConnection::unsubscribe(const std::string& symbol) {
+    {
+        std::lock_guard<std::mutex> lock(symbolsMutex_);
+        symbols_.erase(symbol);
+    }
+    send(provider_->unsubscribeMessage(symbol));
+}
+
+void FeedConnection::send(const std::string& message) {
+    if (state_ != State::Connected) return;
+
+    std::cout << "Sending to " << name_ << ": " << message << std::endl;
+    websocket_outgoing_message msg;
+    msg.set_utf8_message(message);
+
+    auto self = shared_from_this();
+    client_->send(msg).then([self, message](pplx::task<void> sent) {
+        try {
+            sent.get();
+        } catch (const std::exception& e) {
+            std::cerr << "Failed to send " << message << ": " << e.what() << std::endl;
+            self->state_ = State::Failed;
+        }
+    });
+}
+
+FeedConnection::State FeedConnection::state() const {
+    return state_;
+}
+
+const std::string& FeedConnection::name() const {
+    return name_;
+}
+
+bool FeedConnection::hasReceivedTrade() const {
+    return lastTradeTime_ > openedAt_;
+}
+
+bool FeedConnection::isHealthy(long long now, int silenceTime) const {
+    return state_ == State::Connected && now <= lastTradeTime_ + silenceTime;
+}
+
+void FeedConnection::setMuted(bool muted) {
+    muted_ = muted;
+}
+
+long long FeedConnection::takeCoalescedTrades() {
+    return coalescedTrades_.exchange(0);
+}
+
+// Called with messagesMutex_ held, after the queued messages and before any later one.
+void FeedConnection::coalesce(const std::string& message) {
+    if (muted_) {
+        onMessage(message);
+        return;
+    }
+
+    thread_local std::vector<Tick> ticks;
+    ticks.clear();
+    if (!provider_->parse(message, ticks)) return;
+    lastTradeTime_ = time(nullptr);
+
+    for (const auto& tick : ticks) {
+        auto trades = std::find_if(coalesced_.begin(), coalesced_.end(),
+                                   [&tick](const CoalescedTrades& trades) { return trades.symbol == tick.symbol; });
+        if (trades == coalesced_.end()) {
+            coalesced_.push_back(CoalescedTrades{std::string(tick.symbol)});
+            trades = coalesced_.end() - 1;
+        }
+
+        if (trades->count == 0) {
+            trades->first = trades->highest = trades->lowest = tick;
+        } else if (tick.price > trades->highest.price) {
+            trades->highest = tick;
+            trades->highestAt = trades->count;
+        } else if (tick.price < trades->lowest.price) {
+            trades->lowest = tick;
+            trades->lowestAt = trades->count;
+        }
+        trades->last = tick;
+        trades->count += 1;
+    }
+    coalescedTrades_ += ticks.size();
+
+    // one hand-off at the end of the queue takes everything coalesced until it runs
+    if (coalescedQueued_) return;
+    coalescedQueued_ = true;
+    std::weak_ptr<FeedConnection> weakSelf = shared_from_this();
+    lastMessage_ = lastMessage_.then([weakSelf](pplx::task<void>) {
+        auto self = weakSelf.lock();
+        if (!self) return;
+
+        try {
+            self->handCoalesced();
+        } catch (const std::exception& e) {
+            std::cerr << "Exception occurred: " << e.what() << std::endl;
+        }
+    });
+}
+
+void FeedConnection::handCoalesced() {
+    std::vector<CoalescedTrades> coalesced;
+    {
+        std::lock_guard<std::mutex> lock(messagesMutex_);
+        coalesced.swap(coalesced_);
+        coalescedQueued_ = false;
+    }
+
+    // one tick per call like a message per trade, the display keeps one price per call and symbol
+    std::vector<Tick> ticks(1);
+    for (const auto& trades : coalesced) {
+        std::pair<long long, Tick> kept[] = {{0, trades.first}, {trades.highestAt, trades.highest},
+                                             {trades.lowestAt, trades.lowest}, {trades.count - 1, trades.last}};
+        std::stable_sort(std::begin(kept), std::end(kept),
+                         [](const auto& a, const auto& b) { return a.first < b.first; });
+
+        long long handed = -1;
+        for (const auto& [order, tick] : kept) {
+            if (order == handed) continue;
+            handed = order;
+            ticks[0] = tick;
+            ticks[0].symbol = trades.symbol;
+            handler_(ticks);
+        }
+    }
+}
+
+void FeedConnection::onMessage(const std::string& message) {
+    if (muted_) {
+        // pings keep the socket open but do not prove that data flows
+        if (provider_->carriesTrades(message)) {
+            lastTradeTime_ = time(nullptr);
+        }
+        return;
+    }
+
+    // parsing and handling a trade is steady state, the message body itself is allocated by cpprest
+    AllocationScope scope("feed message");
+
+    std::cout << "Received Message: " << message << std::endl;
+    // reused across messages, its capacity settles after the first bursts
+    thread_local std::vector<Tick> ticks;
+    ticks.clear();
+    if (provider_->parse(message, ticks)) {
+        lastTradeTime_ = time(nullptr);
+    }
+
+    if (!ticks.empty()) {
+        handler_(ticks);
+    }
+}
+
+ReconnectBackoff::ReconnectBackoff(std::chrono::milliseconds baseDelay, std::chrono::milliseconds maxDelay)
+    : baseDelay_(baseDelay), maxDelay_(maxDelay) {}
+
+bool ReconnectBackoff::ready(std::chrono::steady_clock::time_point now) const {
+    return now >= nextAttempt_;
+}
+
+std::chrono::milliseconds ReconnectBackoff::failed(std::chrono::steady_clock::time_point now) {
+    std::chrono::milliseconds delay = std::min<std::chrono::milliseconds>(maxDelay_, baseDelay_ * (1 << std::min(attempts_, 16)));
+    attempts_ += 1;
+
+    // equal jitter, half of the delay is fixed and half is random
+    std::uniform_int_distribution<long long> jitter(0, delay.count() / 2);
+    delay = delay / 2 + std::chrono::milliseconds(jitter(random_));
+
+    nextAttempt_ = now + delay;
+    return delay;
+}
+
+void ReconnectBackoff::succeeded() {
+    attempts_ = 0;
+}
+
+void ReconnectBackoff::reset() {
+    attempts_ = 0;
+    nextAttempt_ = std::chrono::steady_clock::time_point();
+}
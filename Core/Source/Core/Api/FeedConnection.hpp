@@ -0,0 +1,113 @@
+#ifndef FEED_CONNECTION_HPP
+#define FEED_CONNECTION_HPP
+
+#include <cpprest/ws_client.h>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <random>
+#include <string>
+#include <vector>
+#include "Core/Api/Providers/MarketDataProvider.hpp"
+
+using namespace web::websockets::client;
+
+constexpr int FEED_MAX_PENDING_MESSAGES = 32; // queued per connection, trades beyond are coalesced
+
+// One WebSocket connection to a market data provider. Opening, subscribing
+// and closing never block the caller, progress is observed through state().
+// Messages are parsed on the connection's own callbacks and handed on as ticks.
+class FeedConnection : public std::enable_shared_from_this<FeedConnection> {
+public:
+    enum class State { Connecting, Connected, Failed };
+    using TickHandler = std::function<void(const std::vector<Tick>&)>;
+
+    FeedConnection(std::shared_ptr<const MarketDataProvider> provider, const std::string& name, TickHandler handler);
+
+    void open(const std::vector<std::string>& symbols);
+    void close();
+    void subscribe(const std::string& symbol);
+    void unsubscribe(const std::string& symbol);
+
+    State state() const;
+    const std::string& name() const;
+    bool hasReceivedTrade() const;
+    bool isHealthy(long long now, int silenceTime) const;
+    // Trades folded into their symbol's extremes under load since the last call.
+    long long takeCoalescedTrades();
+
+    // A muted connection only tracks liveness and drops messages, which is
+    // how the warm standby stays subscribed without duplicating ingest.
+    void setMuted(bool muted);
+
+private:
+    // A symbol's trades that arrived while the queue was full. The first,
+    // highest, lowest and last of them are handed on in arrival order, so the
+    // alerts still see every level the price passed.
+    struct CoalescedTrades {
+        std::string symbol;
+        Tick first{};
+        Tick highest{};
+        Tick lowest{};
+        Tick last{};
+        long long highestAt = 0;   // arrival order among the symbol's trades
+        long long lowestAt = 0;
+        long long count = 0;
+    };
+
+    void onMessage(const std::string& message);
+    void coalesce(const std::string& message);
+    void handCoalesced();
+    void send(const std::string& message);
+
+    std::shared_ptr<const MarketDataProvider> provider_;
+    std::string name_;
+    TickHandler handler_;
+
+    std::unique_ptr<websocket_callback_client> client_;
+
+    // bodies are extracted concurrently, but handled one after the other in arrival order
+    pplx::task<void> lastMessage_ = pplx::task_from_result();
+    std::vector<CoalescedTrades> coalesced_;   // waiting for their turn at the end of the queue
+    bool coalescedQueued_ = false;
+    std::mutex messagesMutex_;
+
+    // symbols this connection should be subscribed to, sent again after connecting
+    std::set<std::string> symbols_;
+    std::mutex symbolsMutex_;
+
+    std::atomic<State> state_ = State::Connecting;
+    std::atomic<long long> openedAt_ = 0;
+    std::atomic<long long> lastTradeTime_ = 0;
+    std::atomic<bool> muted_ = false;
+
+    // Backpressure: at most FEED_MAX_PENDING_MESSAGES messages wait in the queue,
+    // the trades of later ones are coalesced per symbol until it drains, which
+    // bounds the memory of a slow handler by the subscribed symbols.
+    std::atomic<int> pendingMessages_ = 0;
+    std::atomic<long long> coalescedTrades_ = 0;
+};
+
+// Exponential backoff with jitter between reconnect attempts, so a provider
+// outage is not hammered by every ticker reconnecting in lockstep.
+class ReconnectBackoff {
+public:
+    ReconnectBackoff(std::chrono::milliseconds baseDelay, std::chrono::milliseconds maxDelay);
+
+    bool ready(std::chrono::steady_clock::time_point now) const;
+    std::chrono::milliseconds failed(std::chrono::steady_clock::time_point now);
+    void succeeded();
+    void reset();
+
+private:
+    std::chrono::milliseconds baseDelay_;
+    std::chrono::milliseconds maxDelay_;
+    int attempts_ = 0;
+    std::chrono::steady_clock::time_point nextAttempt_;
+    std::mt19937 random_{std::random_device{}()};
+};
+
+#endif // FEED_CONNECTION_HPP
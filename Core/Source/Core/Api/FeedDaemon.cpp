@@ -0,0 +1,161 @@
+#include <csignal>
+#include <ctime>
+#include <iostream>
+#include <limits>
+#include <thread>
+#include "FeedDaemon.hpp"
+#include "Core/System/ThreadPlacement.hpp"
+
+namespace {
+    std::atomic<bool> interruptReceived = false;
+}
+
+static void interruptHandler(int signo) {
+    interruptReceived = true;
+    std::cout << "Interrupt signal received. Stopping the feed daemon." << std::endl;
+}
+
+FeedDaemon::FeedDaemon() : feeds_([this](const std::vector<Tick>& ticks, const std::string& prefix) {
+    if (!interruptReceived) {
+        processTicks(ticks, prefix);
+    }
+}) {
+    std::signal(SIGTERM, interruptHandler);
+    std::signal(SIGINT, interruptHandler);
+}
+
+void FeedDaemon::runForever() {
+    ThreadPlacement::getInstance()->apply(INGEST_THREAD_ROLE);
+
+    std::string path = config_->getFeedBus().empty() ? FEED_BUS_DEFAULT_SOCKET : config_->getFeedBus();
+    if (!server_.open(path)) return;
+
+    long long nextStorageCheckTime = 0;
+    while (!interruptReceived) {
+        // display processes are served as soon as they (un)subscribe
+        subscriptionsCheck(server_.poll(std::chrono::milliseconds(NETWORK_CHECK_TIME)));
+        feeds_.check();
+        staleCheck();
+
+        if (time(nullptr) >= nextStorageCheckTime) {
+            nextStorageCheckTime = time(nullptr) + STORAGE_CHECK_TIME;
+            priceUpdateCheck();
+            dataStorage_->replayCheck();
+            archive_.flush();
+        }
+
+        server_.reportCheck();
+        ThreadPlacement::getInstance()->reportCheck();
+    }
+
+    feeds_.reset();
+    server_.close();
+    archive_.close();
+    std::cout << "Feed daemon stopped" << std::endl;
+}
+
+void FeedDaemon::processTicks(const std::vector<Tick>& ticks, const std::string& prefix) {
+    thread_local std::string apiSymbol;
+    FeedBusMessage message;
+    for (const auto& tick : ticks) {
+        apiSymbol.assign(prefix).append(tick.symbol);
+        {
+            std::lock_guard<std::mutex> lock(symbolsMutex_);
+            auto symbol = symbols_.find(apiSymbol);
+            if (symbol == symbols_.end()) continue;
+            symbol->second.price = tick.price;
+            symbol->second.lastTradeTime = tick.time;
+        }
+
+        if (config_->getTickArchive()) {
+            archive_.append(apiSymbol, tick.tradeTime != 0 ? tick.tradeTime : tick.time * 1000, tick.price);
+        }
+
+        // every trade goes out, the displays check their alerts against each one
+        if (makeFeedBusMessage(message, FeedBusType::Tick, apiSymbol, tick.price, tick.time)) {
+            server_.publish(apiSymbol, message);
+        }
+    }
+
+    if (!receivedFirstUpdate_) receivedFirstUpdate_ = true;
+}
+
+void FeedDaemon::subscriptionsCheck(bool changed) {
+    if (!changed) return;
+
+    std::vector<std::string> apiSymbols = server_.subscriptions();
+    {
+        // symbols that stay keep their last price, so their next bar is not empty
+        std::lock_guard<std::mutex> lock(symbolsMutex_);
+        std::unordered_map<std::string, SymbolState> symbols;
+        for (const auto& apiSymbol : apiSymbols) {
+            auto existing = symbols_.find(apiSymbol);
+            symbols[apiSymbol] = existing != symbols_.end() ? existing->second : SymbolState{MISSING_PRICE, time(nullptr)};
+        }
+        symbols_.swap(symbols);
+    }
+
+    std::cout << "Feed daemon serving " << apiSymbols.size() << " symbols" << std::endl;
+    feeds_.setSymbols(apiSymbols);
+}
+
+void FeedDaemon::staleCheck() {
+    long long now = time(nullptr);
+    if (now < nextStaleCheckTime_) return;
+    nextStaleCheckTime_ = now + STALE_SYMBOL_TIME;
+
+    std::vector<std::string> stale;
+    {
+        std::lock_guard<std::mutex> lock(symbolsMutex_);
+        for (const auto& [apiSymbol, symbol] : symbols_) {
+            if (now > symbol.lastTradeTime + STALE_SYMBOL_TIME) {
+                stale.push_back(apiSymbol);
+            }
+        }
+    }
+    feeds_.resubscribe(stale);
+}
+
+// Same sampling as a session storing its own prices, the stored value of
+// every symbol then goes out as a bar for the displays to append to their charts.
+void FeedDaemon::priceUpdateCheck() {
+    if (!receivedFirstUpdate_) return;
+
+    int secondsSinceLastUpdate = dataStorage_->secondsSinceLastUpdate();
+    if (secondsSinceLastUpdate == std::numeric_limits<int>::max()) {
+        secondsSinceLastUpdate = PRICE_TIME_INTERVAL;
+    }
+
+    bool savePrice = (secondsSinceLastUpdate >= PRICE_TIME_INTERVAL &&
+                     (secondsSinceLastUpdate % PRICE_TIME_INTERVAL) < ALLOWABLE_DISSYNCHRONIZATION_TIME);
+    if (!savePrice) return;
+
+    // closed markets are neither stored nor sent, the displays keep their last session
+    long long now = time(nullptr);
+    std::vector<std::pair<std::string, double>> bars;
+    {
+        std::lock_guard<std::mutex> lock(symbolsMutex_);
+        for (const auto& [apiSymbol, symbol] : symbols_) {
+            if (calendar_->isOpen(apiSymbol, now)) {
+                bars.emplace_back(apiSymbol, symbol.price);
+            }
+        }
+    }
+    if (bars.empty()) return;
+
+    std::vector<std::pair<std::string, double>> prices;
+    for (const auto& bar : bars) {
+        if (bar.second != MISSING_PRICE) {
+            prices.push_back(bar);
+        }
+    }
+    dataStorage_->savePrices(prices);
+    std::cout << "Saved prices: " << prices.size() << std::endl;
+
+    FeedBusMessage message;
+    for (const auto& [apiSymbol, price] : bars) {
+        if (makeFeedBusMessage(message, FeedBusType::Bar, apiSymbol, price, now)) {
+            server_.publish(apiSymbol, message);
+        }
+    }
+}
@@ -0,0 +1,54 @@
+#ifndef FEED_DAEMON_HPP
+#define FEED_DAEMON_HPP
+
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "Core/Config.hpp"
+#include "Core/Api/FeedBus.hpp"
+#include "Core/Api/FeedManager.hpp"
+#include "Core/Database/DataStorage.hpp"
+#include "Core/Database/TickArchive.hpp"
+#include "Core/Market/TradingCalendar.hpp"
+#include "Core/GlobalParams.hpp"
+
+// The ingest half of a session as its own process. It keeps one set of
+// provider connections for the union of the symbols its display processes
+// subscribe to, stores the per-minute prices once, and multicasts every
+// tick and every stored bar over the feed bus.
+class FeedDaemon {
+public:
+    FeedDaemon();
+
+    void runForever();
+
+private:
+    struct SymbolState {
+        double price = MISSING_PRICE;
+        long long lastTradeTime = 0;
+    };
+
+    void processTicks(const std::vector<Tick>& ticks, const std::string& prefix);
+    void subscriptionsCheck(bool changed);
+    void staleCheck();
+    void priceUpdateCheck();
+
+    Config *config_ = Config::getInstance(CONFIG_FILE);
+    DataStorage* dataStorage_ = DataStorage::getInstance();
+    TradingCalendar* calendar_ = TradingCalendar::getInstance();
+
+    FeedBusServer server_;
+    FeedManager feeds_;
+    TickArchive archive_{TICK_ARCHIVE_DIR};
+
+    // latest trade per subscribed api symbol, written by the feed callbacks
+    std::unordered_map<std::string, SymbolState> symbols_;
+    std::mutex symbolsMutex_;
+
+    std::atomic<bool> receivedFirstUpdate_ = false;
+    long long nextStaleCheckTime_ = 0;
+};
+
+#endif // FEED_DAEMON_HPP
@@ -0,0 +1,235 @@
+#include <ctime>
+#include <iostream>
+#include <limits>
+#include <unordered_set>
+#include "FeedManager.hpp"
+#include "Core/Api/Providers/FinnhubProvider.hpp"
+
+// Symbols of the first list that are not in the second one
+std::vector<std::string> symbolsMissingFrom(const std::vector<std::string>& symbols, const std::vector<std::string>& other) {
+    std::unordered_set<std::string> otherSet(other.begin(), other.end());
+    std::vector<std::string> missing;
+    for (const auto& symbol : symbols) {
+        if (otherSet.find(symbol) == otherSet.end()) {
+            missing.push_back(symbol);
+        }
+    }
+    return missing;
+}
+
+FeedManager::FeedManager(TickHandler handler) : handler_(std::move(handler)) {
+    for (const auto& name : config_->getFeedProviders()) {
+        auto provider = createProvider(name, config_->getToken(), config_->getSymbolsPerConnection());
+        if (provider) {
+            providers_.push_back(provider);
+        }
+    }
+    if (providers_.empty()) {
+        providers_.push_back(createProvider(FINNHUB_PROVIDER, config_->getToken(), config_->getSymbolsPerConnection()));
+    }
+}
+
+void FeedManager::setSymbols(const std::vector<std::string>& apiSymbols) {
+    std::vector<std::string> addedSymbols = symbolsMissingFrom(apiSymbols, apiSymbols_);
+    std::vector<std::string> removedSymbols = symbolsMissingFrom(apiSymbols_, apiSymbols);
+    apiSymbols_ = apiSymbols;
+
+    if (shards_.empty()) {
+        rebuildShards();
+        return;
+    }
+
+    // the live sockets only get the difference, symbols that stayed keep their state
+    std::cout << "Subscriptions added: " << addedSymbols.size() << ", removed: " << removedSymbols.size() << std::endl;
+    for (const auto& symbol : removedSymbols) {
+        removeSymbol(symbol);
+    }
+    for (const auto& symbol : addedSymbols) {
+        addSymbol(symbol);
+    }
+}
+
+std::shared_ptr<FeedConnection> FeedManager::openFeed(const FeedShard& shard, const std::string& role, bool muted) {
+    std::string prefix = apiPrefix(shard);
+
+    auto feed = std::make_shared<FeedConnection>(shard.provider, shard.name() + " " + role, [this, prefix](const std::vector<Tick>& ticks) {
+        handler_(ticks, prefix);
+    });
+    feed->setMuted(muted);
+    feed->open(shard.symbols);
+    return feed;
+}
+
+void FeedManager::maintainFeed(FeedShard& shard, std::shared_ptr<FeedConnection>& feed, ReconnectBackoff& backoff,
+                               const std::string& role, bool muted, int silenceTime) {
+    auto now = std::chrono::steady_clock::now();
+
+    if (feed) {
+        if (feed->state() == FeedConnection::State::Connecting) return;
+
+        if (feed->isHealthy(time(nullptr), silenceTime)) {
+            if (feed->hasReceivedTrade()) backoff.succeeded();
+            return;
+        }
+
+        // dropped or gone quiet, retried later without blocking this thread
+        auto delay = backoff.failed(now);
+        std::cout << "Reconnecting " << shard.name() << " " << role << " feed in " << delay.count() << "ms..." << std::endl;
+        feed->close();
+        feed.reset();
+    }
+
+    if (backoff.ready(now)) {
+        feed = openFeed(shard, role, muted);
+    }
+}
+
+void FeedManager::check() {
+    long long now = time(nullptr);
+
+    for (auto& shard : shards_) {
+        int silence = silenceTime(shard, now);
+
+        // promote the warm standby as soon as the primary drops or goes quiet
+        bool primaryLost = shard.primary && shard.primary->state() != FeedConnection::State::Connecting &&
+                           !shard.primary->isHealthy(now, silence);
+        if (primaryLost && shard.standby && shard.standby->isHealthy(now, silence) && shard.standby->hasReceivedTrade()) {
+            std::cout << "Promoting standby connection of " << shard.name() << "..." << std::endl;
+            shard.primary->close();
+            shard.primary = shard.standby;
+            shard.primary->setMuted(false);
+            shard.standby.reset();
+            shard.primaryBackoff.succeeded();
+        }
+
+        maintainFeed(shard, shard.primary, shard.primaryBackoff, "primary", false, silence);
+        if (config_->getStandbyConnection()) {
+            maintainFeed(shard, shard.standby, shard.standbyBackoff, "standby", true, silence);
+        }
+    }
+
+    for (auto& shard : shards_) {
+        if (!shard.primary) continue;
+        long long coalesced = shard.primary->takeCoalescedTrades();
+        if (coalesced > 0) {
+            std::cout << "Coalesced " << coalesced << " trades on " << shard.name() << " under load" << std::endl;
+        }
+    }
+}
+
+// Shards whose markets are all closed go without trades for hours, they only have to stay connected.
+int FeedManager::silenceTime(const FeedShard& shard, long long now) const {
+    // the calendar is keyed by api symbols, shards hold the provider's own names
+    std::string prefix = apiPrefix(shard);
+    std::string apiSymbol;
+    for (const auto& symbol : shard.symbols) {
+        apiSymbol.assign(prefix).append(symbol);
+        if (calendar_->isOpen(apiSymbol, now)) {
+            return FEED_SILENCE_TIME;
+        }
+    }
+    return std::numeric_limits<int>::max();
+}
+
+// Symbols of secondary providers are qualified as <provider>@<symbol> in the watchlist.
+std::string FeedManager::apiPrefix(const FeedShard& shard) const {
+    return shard.provider == providers_.front() ? "" : shard.provider->name() + PROVIDER_SEPARATOR;
+}
+
+void FeedManager::resubscribe(const std::vector<std::string>& apiSymbols) {
+    long long now = time(nullptr);
+
+    for (const auto& apiSymbol : apiSymbols) {
+        // closed markets are silent by design
+        if (!calendar_->isOpen(apiSymbol, now)) continue;
+
+        std::string symbol;
+        FeedShard* shard = findShard(apiSymbol, symbol);
+        if (shard != nullptr && shard->primary && shard->primary->isHealthy(now, FEED_SILENCE_TIME)) {
+            std::cout << "No trades for " << apiSymbol << " in " << STALE_SYMBOL_TIME << "s, resubscribing..." << std::endl;
+            shard->primary->subscribe(symbol);
+        }
+    }
+}
+
+void FeedManager::reset() {
+    std::cout << "Disconnecting..." << std::endl;
+    for (auto& shard : shards_) {
+        for (auto* feed : {&shard.primary, &shard.standby}) {
+            if (*feed) {
+                (*feed)->close();
+                feed->reset();
+            }
+        }
+    }
+    shards_.clear();
+}
+
+bool FeedManager::empty() const {
+    return shards_.empty();
+}
+
+void FeedManager::rebuildShards() {
+    reset();
+    for (const auto& apiSymbol : apiSymbols_) {
+        addSymbol(apiSymbol);
+    }
+    std::cout << "Watchlist split into " << shards_.size() << " feed connections" << std::endl;
+}
+
+int FeedManager::routeSymbol(const std::string& apiSymbol, std::string& symbol) const {
+    size_t separator = apiSymbol.find(PROVIDER_SEPARATOR);
+    if (separator != std::string::npos) {
+        std::string providerName = apiSymbol.substr(0, separator);
+        for (size_t i = 0; i < providers_.size(); i += 1) {
+            if (providers_[i]->name() == providerName) {
+                symbol = apiSymbol.substr(separator + PROVIDER_SEPARATOR.size());
+                return i;
+            }
+        }
+    }
+
+    symbol = apiSymbol;
+    return 0;
+}
+
+FeedShard* FeedManager::findShard(const std::string& apiSymbol, std::string& symbol) {
+    auto& provider = providers_[routeSymbol(apiSymbol, symbol)];
+    for (auto& shard : shards_) {
+        if (shard.provider == provider && shard.contains(symbol)) {
+            return &shard;
+        }
+    }
+    return nullptr;
+}
+
+void FeedManager::addSymbol(const std::string& apiSymbol) {
+    std::string symbol;
+    auto& provider = providers_[routeSymbol(apiSymbol, symbol)];
+
+    for (auto& shard : shards_) {
+        if (shard.provider == provider && !shard.isFull()) {
+            shard.add(symbol);
+            return;
+        }
+    }
+
+    // connections of a new shard are opened by the next check
+    shards_.emplace_back(provider, nextShardId_++);
+    shards_.back().add(symbol);
+}
+
+void FeedManager::removeSymbol(const std::string& apiSymbol) {
+    std::string symbol;
+    FeedShard* shard = findShard(apiSymbol, symbol);
+    if (shard == nullptr) return;
+
+    shard->remove(symbol);
+
+    if (shard->symbols.empty()) {
+        for (auto* feed : {&shard->primary, &shard->standby}) {
+            if (*feed) (*feed)->close();
+        }
+        shards_.erase(shards_.begin() + (shard - shards_.data()));
+    }
+}
@@ -0,0 +1,63 @@
+#ifndef FEED_MANAGER_HPP
+#define FEED_MANAGER_HPP
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+#include "Core/Config.hpp"
+#include "Core/Api/FeedConnection.hpp"
+#include "Core/Api/FeedShard.hpp"
+#include "Core/Api/Providers/MarketDataProvider.hpp"
+#include "Core/Market/TradingCalendar.hpp"
+#include "Core/GlobalParams.hpp"
+
+// Symbols of the first list that are not in the second one
+std::vector<std::string> symbolsMissingFrom(const std::vector<std::string>& symbols, const std::vector<std::string>& other);
+
+// Upstream market data for a set of api symbols: routes them to providers,
+// splits them into shards and keeps every shard's connections alive. Used by
+// a session reading the providers itself and by the feed daemon. Only the
+// owning thread calls it, ticks arrive on the connections' callbacks.
+class FeedManager {
+public:
+    // prefix is what turns a provider symbol back into the api symbol
+    using TickHandler = std::function<void(const std::vector<Tick>& ticks, const std::string& prefix)>;
+
+    FeedManager(TickHandler handler);
+
+    // Subscribes to exactly these symbols, live connections only get the difference.
+    void setSymbols(const std::vector<std::string>& apiSymbols);
+    // Reconnects dropped or silent connections and promotes standbys, never blocks.
+    void check();
+    // A healthy feed with silent symbols usually means a dropped subscription.
+    void resubscribe(const std::vector<std::string>& apiSymbols);
+    void reset();
+
+    bool empty() const;
+
+private:
+    std::shared_ptr<FeedConnection> openFeed(const FeedShard& shard, const std::string& role, bool muted);
+    void maintainFeed(FeedShard& shard, std::shared_ptr<FeedConnection>& feed, ReconnectBackoff& backoff,
+                      const std::string& role, bool muted, int silenceTime);
+    int silenceTime(const FeedShard& shard, long long now) const;
+    std::string apiPrefix(const FeedShard& shard) const;
+    void rebuildShards();
+    int routeSymbol(const std::string& apiSymbol, std::string& symbol) const;
+    FeedShard* findShard(const std::string& apiSymbol, std::string& symbol);
+    void addSymbol(const std::string& apiSymbol);
+    void removeSymbol(const std::string& apiSymbol);
+
+    Config *config_ = Config::getInstance(CONFIG_FILE);
+    TradingCalendar* calendar_ = TradingCalendar::getInstance();
+
+    TickHandler handler_;
+
+    // The first provider serves unqualified symbols.
+    std::vector<std::shared_ptr<const MarketDataProvider>> providers_;
+    std::vector<FeedShard> shards_;
+    std::vector<std::string> apiSymbols_;
+    int nextShardId_ = 0;
+};
+
+#endif // FEED_MANAGER_HPP
@@ -0,0 +1,31 @@
+#include <algorithm>
+#include "FeedShard.hpp"
+
+FeedShard::FeedShard(std::shared_ptr<const MarketDataProvider> provider, int id)
+    : provider(std::move(provider)), id(id) {}
+
+std::string FeedShard::name() const {
+    return provider->name() + "#" + std::to_string(id);
+}
+
+bool FeedShard::contains(const std::string& symbol) const {
+    return std::find(symbols.begin(), symbols.end(), symbol) != symbols.end();
+}
+
+bool FeedShard::isFull() const {
+    return symbols.size() >= provider->maxSymbolsPerConnection();
+}
+
+void FeedShard::add(const std::string& symbol) {
+    symbols.push_back(symbol);
+    for (auto* feed : {primary.get(), standby.get()}) {
+        if (feed != nullptr) feed->subscribe(symbol);
+    }
+}
+
+void FeedShard::remove(const std::string& symbol) {
+    symbols.erase(std::remove(symbols.begin(), symbols.end(), symbol), symbols.end());
+    for (auto* feed : {primary.get(), standby.get()}) {
+        if (feed != nullptr) feed->unsubscribe(symbol);
+    }
+}
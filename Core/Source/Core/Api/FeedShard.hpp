@@ -0,0 +1,32 @@
+#ifndef FEED_SHARD_HPP
+#define FEED_SHARD_HPP
+
+#include <memory>
+#include <string>
+#include <vector>
+#include "Core/Api/FeedConnection.hpp"
+#include "Core/Api/Providers/MarketDataProvider.hpp"
+#include "Core/GlobalParams.hpp"
+
+// A slice of the watchlist, at most maxSymbolsPerConnection() symbols of one
+// provider, served by its own primary and optional standby connection.
+struct FeedShard {
+    FeedShard(std::shared_ptr<const MarketDataProvider> provider, int id);
+
+    std::string name() const;
+    bool contains(const std::string& symbol) const;
+    bool isFull() const;
+    void add(const std::string& symbol);
+    void remove(const std::string& symbol);
+
+    std::shared_ptr<const MarketDataProvider> provider;
+    int id;
+    std::vector<std::string> symbols;   // provider symbol names
+
+    std::shared_ptr<FeedConnection> primary;
+    std::shared_ptr<FeedConnection> standby;
+    ReconnectBackoff primaryBackoff{std::chrono::milliseconds(RECONNECT_BASE_DELAY), std::chrono::milliseconds(RECONNECT_MAX_DELAY)};
+    ReconnectBackoff standbyBackoff{std::chrono::milliseconds(RECONNECT_BASE_DELAY), std::chrono::milliseconds(RECONNECT_MAX_DELAY)};
+};
+
+#endif // FEED_SHARD_HPP
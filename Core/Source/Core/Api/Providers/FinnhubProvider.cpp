@@ -0,0 +1,192 @@
+#include <charconv>
+#include <ctime>
+#include <iostream>
+#include "FinnhubProvider.hpp"
+
+namespace {
+    const std::string FINNHUB_URL = "wss://ws.finnhub.io/?token=";
+
+    // Scans the flat Finnhub messages in place. Strings are returned as views into
+    // the message without unescaping, which symbols and message types never need,
+    // so a trade is parsed without a single allocation.
+    class MessageScanner {
+    public:
+        explicit MessageScanner(std::string_view text) : text_(text) {}
+
+        bool consume(char c) {
+            skipSpace();
+            if (pos_ >= text_.size() || text_[pos_] != c) return false;
+            pos_ += 1;
+            return true;
+        }
+
+        bool string(std::string_view& value) {
+            if (!consume('"')) return false;
+            size_t start = pos_;
+            while (pos_ < text_.size() && text_[pos_] != '"') {
+                pos_ += text_[pos_] == '\\' ? 2 : 1;
+            }
+            if (pos_ >= text_.size()) return false;
+            value = text_.substr(start, pos_ - start);
+            pos_ += 1;
+            return true;
+        }
+
+        // null reads as zero like in the JSON library
+        bool number(double& value) {
+            skipSpace();
+            if (text_.substr(pos_, 4) == "null") {
+                pos_ += 4;
+                value = 0;
+                return true;
+            }
+            auto result = std::from_chars(text_.data() + pos_, text_.data() + text_.size(), value);
+            if (result.ec != std::errc()) return false;
+            pos_ = result.ptr - text_.data();
+            return true;
+        }
+
+        bool skipValue() {
+            skipSpace();
+            if (pos_ >= text_.size()) return false;
+
+            std::string_view ignored;
+            if (text_[pos_] == '"') return string(ignored);
+            if (text_[pos_] != '{' && text_[pos_] != '[') {
+                while (pos_ < text_.size() && text_[pos_] != ',' && text_[pos_] != '}' && text_[pos_] != ']') {
+                    pos_ += 1;
+                }
+                return true;
+            }
+
+            int depth = 0;
+            while (pos_ < text_.size()) {
+                char c = text_[pos_];
+                if (c == '"') {
+                    if (!string(ignored)) return false;
+                    continue;
+                }
+                pos_ += 1;
+                if (c == '{' || c == '[') depth += 1;
+                if ((c == '}' || c == ']') && --depth == 0) return true;
+            }
+            return false;
+        }
+
+        bool peek(char c) {
+            skipSpace();
+            return pos_ < text_.size() && text_[pos_] == c;
+        }
+
+    private:
+        void skipSpace() {
+            while (pos_ < text_.size() && (text_[pos_] == ' ' || text_[pos_] == '\n' ||
+                                           text_[pos_] == '\r' || text_[pos_] == '\t')) {
+                pos_ += 1;
+            }
+        }
+
+        std::string_view text_;
+        size_t pos_ = 0;
+    };
+
+    // {"p": 7296.89, "s": "BINANCE:BTCUSDT", "t": 1575526691134, "v": 0.011, "c": null}, t in milliseconds
+    bool scanTrade(MessageScanner& scanner, std::vector<Tick>& ticks, long long receivedAt) {
+        if (!scanner.consume('{')) return false;
+
+        Tick tick{std::string_view(), 0, receivedAt};
+        double tradeTime = 0;
+        while (!scanner.consume('}')) {
+            std::string_view key;
+            if (!scanner.string(key) || !scanner.consume(':')) return false;
+
+            bool scanned = key == "p" ? scanner.number(tick.price) :
+                           key == "s" ? scanner.string(tick.symbol) :
+                           key == "t" ? scanner.number(tradeTime) :
+                           scanner.skipValue();
+            if (!scanned) return false;
+            scanner.consume(',');
+        }
+        tick.tradeTime = static_cast<long long>(tradeTime);
+
+        if (tick.price != 0) {
+            ticks.push_back(tick);
+        }
+        return true;
+    }
+
+    // {"data": [trade, ...], "type": "trade"}, the keys may come in any order
+    bool scanMessage(std::string_view message, std::string_view& type, std::vector<Tick>& ticks, long long receivedAt) {
+        MessageScanner scanner(message);
+        if (!scanner.consume('{')) return false;
+
+        while (!scanner.consume('}')) {
+            std::string_view key;
+            if (!scanner.string(key) || !scanner.consume(':')) return false;
+
+            if (key == "type") {
+                if (!scanner.string(type)) return false;
+            } else if (key == "data" && scanner.peek('[')) {
+                scanner.consume('[');
+                while (!scanner.consume(']')) {
+                    if (!scanTrade(scanner, ticks, receivedAt)) return false;
+                    scanner.consume(',');
+                }
+            } else if (!scanner.skipValue()) {
+                return false;
+            }
+            scanner.consume(',');
+        }
+        return true;
+    }
+}
+
+FinnhubProvider::FinnhubProvider(const std::string& token, int maxSymbolsPerConnection)
+    : token_(token), maxSymbolsPerConnection_(maxSymbolsPerConnection) {}
+
+std::string FinnhubProvider::name() const {
+    return FINNHUB_PROVIDER;
+}
+
+std::string FinnhubProvider::url() const {
+    return FINNHUB_URL + token_;
+}
+
+int FinnhubProvider::maxSymbolsPerConnection() const {
+    return maxSymbolsPerConnection_;
+}
+
+std::string FinnhubProvider::subscribeMessage(const std::string& symbol) const {
+    return "{\"type\":\"subscribe\",\"symbol\":\"" + symbol + "\"}";
+}
+
+std::string FinnhubProvider::unsubscribeMessage(const std::string& symbol) const {
+    return "{\"type\":\"unsubscribe\",\"symbol\":\"" + symbol + "\"}";
+}
+
+bool FinnhubProvider::parse(const std::string& message, std::vector<Tick>& ticks) const {
+    size_t firstTick = ticks.size();
+    std::string_view type;
+    if (!scanMessage(message, type, ticks, time(nullptr))) {
+        std::cout << "Error parsing JSON" << std::endl;
+        ticks.resize(firstTick);
+        return false;
+    }
+
+    if (type == "ping") {
+        std::cout << "Received ping" << std::endl;
+        return false;
+    }
+
+    if (type != "trade") {
+        ticks.resize(firstTick);
+        return false;
+    }
+
+    std::cout << "Received trade" << std::endl;
+    return true;
+}
+
+bool FinnhubProvider::carriesTrades(const std::string& message) const {
+    return message.find("\"type\":\"trade\"") != std::string::npos;
+}
@@ -0,0 +1,27 @@
+#ifndef FINNHUB_PROVIDER_HPP
+#define FINNHUB_PROVIDER_HPP
+
+#include "Core/Api/Providers/MarketDataProvider.hpp"
+
+const std::string FINNHUB_PROVIDER = "finnhub";
+
+class FinnhubProvider : public MarketDataProvider {
+public:
+    FinnhubProvider(const std::string& token, int maxSymbolsPerConnection);
+
+    std::string name() const override;
+    std::string url() const override;
+    int maxSymbolsPerConnection() const override;
+
+    std::string subscribeMessage(const std::string& symbol) const override;
+    std::string unsubscribeMessage(const std::string& symbol) const override;
+
+    bool parse(const std::string& message, std::vector<Tick>& ticks) const override;
+    bool carriesTrades(const std::string& message) const override;
+
+private:
+    std::string token_;
+    int maxSymbolsPerConnection_;
+};
+
+#endif // FINNHUB_PROVIDER_HPP
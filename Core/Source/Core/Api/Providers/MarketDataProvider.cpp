@@ -0,0 +1,13 @@
+#include <iostream>
+#include "MarketDataProvider.hpp"
+#include "FinnhubProvider.hpp"
+
+std::shared_ptr<const MarketDataProvider> createProvider(const std::string& name, const std::string& token,
+                                                         int maxSymbolsPerConnection) {
+    if (name == FINNHUB_PROVIDER) {
+        return std::make_shared<FinnhubProvider>(token, maxSymbolsPerConnection);
+    }
+
+    std::cerr << "Unknown market data provider: " << name << std::endl;
+    return nullptr;
+}
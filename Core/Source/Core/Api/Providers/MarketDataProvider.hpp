@@ -0,0 +1,42 @@
+#ifndef MARKET_DATA_PROVIDER_HPP
+#define MARKET_DATA_PROVIDER_HPP
+
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// A trade normalised from any provider's wire format. The symbol points into
+// the parsed message and is only valid while the tick handler runs.
+struct Tick {
+    std::string_view symbol;   // provider's own symbol name
+    double price;
+    long long time;       // seconds since epoch
+    long long tradeTime = 0;   // exchange time in milliseconds since epoch, 0 when not provided
+};
+
+// Everything that differs between market data sources. Implementations are
+// stateless, so one instance is shared by all connections of a provider.
+class MarketDataProvider {
+public:
+    virtual ~MarketDataProvider() = default;
+
+    virtual std::string name() const = 0;
+    virtual std::string url() const = 0;
+    virtual int maxSymbolsPerConnection() const = 0;
+
+    virtual std::string subscribeMessage(const std::string& symbol) const = 0;
+    virtual std::string unsubscribeMessage(const std::string& symbol) const = 0;
+
+    // Appends the trades carried by a message. Returns false for messages
+    // without trades (pings, errors), which do not prove the feed is alive.
+    virtual bool parse(const std::string& message, std::vector<Tick>& ticks) const = 0;
+
+    // Cheap liveness check used by connections that do not parse, like the standby.
+    virtual bool carriesTrades(const std::string& message) const = 0;
+};
+
+std::shared_ptr<const MarketDataProvider> createProvider(const std::string& name, const std::string& token,
+                                                         int maxSymbolsPerConnection);
+
+#endif // MARKET_DATA_PROVIDER_HPP
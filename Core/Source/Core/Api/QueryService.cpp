@@ -0,0 +1,231 @@
+#include <json/json.h>
+#include <algorithm>
+#include <ctime>
+#include <iostream>
+#include "QueryService.hpp"
+#include "Core/Market/Timeframe.hpp"
+#include "Core/GlobalParams.hpp"
+
+using namespace web::http;
+using namespace web::http::experimental::listener;
+
+namespace {
+    const std::string JSON_CONTENT_TYPE = "application/json";
+
+    std::string toJson(const Json::Value& root) {
+        Json::StreamWriterBuilder builder;
+        builder["indentation"] = "";
+        return Json::writeString(builder, root);
+    }
+
+    Json::Value priceValue(double price) {
+        return price == MISSING_PRICE ? Json::Value(Json::nullValue) : Json::Value(price);
+    }
+
+    std::string chartBody(const std::string& apiSymbol, const std::string& source,
+                          std::deque<double>::const_iterator begin, std::deque<double>::const_iterator end) {
+        Json::Value root;
+        root["symbol"] = apiSymbol;
+        root["source"] = source;
+        root["interval"] = PRICE_TIME_INTERVAL;
+        root["prices"] = Json::Value(Json::arrayValue);
+        for (auto it = begin; it != end; ++it) {
+            root["prices"].append(priceValue(*it));
+        }
+        return toJson(root);
+    }
+
+    std::string barsBody(const std::string& apiSymbol, const Timeframe& timeframe,
+                         const std::vector<std::pair<double, double>>& points) {
+        Json::Value root;
+        root["symbol"] = apiSymbol;
+        root["timeframe"] = timeframe.name;
+        root["bucket"] = timeframe.bucket;
+        root["bars"] = Json::Value(Json::arrayValue);
+        for (const auto& [time, close] : points) {
+            Json::Value bar;
+            bar["time"] = static_cast<Json::Int64>(time);
+            bar["close"] = close;
+            root["bars"].append(bar);
+        }
+        return toJson(root);
+    }
+}
+
+QueryService::QueryService(const std::string& address, MarketState& market)
+    : address_(address), listener_(address), market_(market), lastReport_(std::chrono::steady_clock::now()) {
+    listener_.support([this](http_request request) {
+        handle(request);
+    });
+}
+
+bool QueryService::open() {
+    try {
+        listener_.open().wait();
+        std::cout << "Query service listening on " << address_ << std::endl;
+        return true;
+    } catch (const std::exception &e) {
+        std::cerr << "Could not open the query service on " << address_ << ": " << e.what() << std::endl;
+        return false;
+    }
+}
+
+void QueryService::close() {
+    try {
+        listener_.close().wait();
+    } catch (const std::exception &e) {
+        std::cerr << "Could not close the query service: " << e.what() << std::endl;
+    }
+}
+
+// Runs on the listener's thread pool, never on a session thread.
+void QueryService::handle(http_request request) {
+    requests_ += 1;
+    if (request.method() != methods::GET) {
+        request.reply(status_codes::MethodNotAllowed);
+        return;
+    }
+
+    auto path = web::uri::split_path(web::uri::decode(request.relative_uri().path()));
+    auto query = web::uri::split_query(request.relative_uri().query());
+    auto param = [&query](const std::string& key, const std::string& fallback) {
+        auto it = query.find(key);
+        return it != query.end() ? web::uri::decode(it->second) : fallback;
+    };
+    std::string endpoint = path.empty() ? "" : path.front();
+
+    if (endpoint == "prices") {
+        memoryHits_ += 1;
+        request.reply(status_codes::OK, pricesBody(), JSON_CONTENT_TYPE);
+        return;
+    }
+
+    if (endpoint != "chart" && endpoint != "bars") {
+        request.reply(status_codes::NotFound);
+        return;
+    }
+
+    std::string apiSymbol = param("symbol", "");
+    if (apiSymbol.empty()) {
+        request.reply(status_codes::BadRequest, "symbol is required");
+        return;
+    }
+
+    int minutes = QUERY_DEFAULT_MINUTES;
+    const Timeframe* timeframe = nullptr;
+    if (endpoint == "bars") {
+        timeframe = &findTimeframe(param("timeframe", "1d"));
+        // the raw timeframe has no bars, it is the per-minute chart
+        if (timeframe->table.empty()) {
+            minutes = timeframe->span / 60;
+            timeframe = nullptr;
+        }
+    } else {
+        try {
+            minutes = std::clamp(std::stoi(param("minutes", std::to_string(QUERY_DEFAULT_MINUTES))), 1, QUERY_MAX_MINUTES);
+        } catch (const std::exception &e) {
+            request.reply(status_codes::BadRequest, "minutes must be a number");
+            return;
+        }
+    }
+
+    auto reply = [request](const std::string& body) {
+        request.reply(status_codes::OK, body, JSON_CONTENT_TYPE);
+    };
+
+    if (timeframe != nullptr) {
+        cached("bars:" + timeframe->name + ":" + apiSymbol, [this, apiSymbol, bars = *timeframe]() {
+            return barsBody(apiSymbol, bars, reader_.getRollupHistory(apiSymbol, bars.table, bars.span));
+        }).then(reply);
+        return;
+    }
+
+    std::string body;
+    if (chartFromMemory(apiSymbol, minutes, body)) {
+        memoryHits_ += 1;
+        reply(body);
+        return;
+    }
+
+    cached("chart:" + std::to_string(minutes) + ":" + apiSymbol, [this, apiSymbol, minutes]() {
+        std::deque<double> prices = reader_.getPriceHistory(apiSymbol, minutes);
+        return chartBody(apiSymbol, "storage", prices.cbegin(), prices.cend());
+    }).then(reply);
+}
+
+std::string QueryService::pricesBody() {
+    auto snapshot = market_.snapshot();
+
+    Json::Value root(Json::arrayValue);
+    for (const auto& symbol : snapshot->symbols) {
+        Json::Value entry;
+        entry["symbol"] = symbol.apiName;
+        entry["name"] = symbol.name;
+        entry["price"] = priceValue(symbol.price != MISSING_PRICE ? symbol.price : symbol.lastStoredPrice);
+        entry["reference"] = priceValue(symbol.referencePrice);
+        root.append(entry);
+    }
+    return toJson(root);
+}
+
+// Live charts of the watchlist already hold the latest samples, no query needed.
+bool QueryService::chartFromMemory(const std::string& apiSymbol, int minutes, std::string& body) {
+    auto snapshot = market_.snapshot();
+    for (const auto& symbol : snapshot->symbols) {
+        if (symbol.apiName != apiSymbol) continue;
+        if (!symbol.historyLoaded || !symbol.liveChart || !symbol.chart ||
+            symbol.chart->size() < static_cast<size_t>(minutes)) return false;
+
+        body = chartBody(apiSymbol, "memory", symbol.chart->cend() - minutes, symbol.chart->cend());
+        return true;
+    }
+    return false;
+}
+
+// Identical requests share the query in flight, finished results are served
+// until they expire. At most one storage read runs at a time, the reader holds its own lock.
+pplx::task<std::string> QueryService::cached(const std::string& key, std::function<std::string()> fetch) {
+    std::lock_guard<std::mutex> lock(cacheMutex_);
+    long long now = time(nullptr);
+
+    auto it = cache_.find(key);
+    if (it != cache_.end()) {
+        if (!it->second.body.is_done()) {
+            coalesced_ += 1;
+            return it->second.body;
+        }
+        if (now < it->second.fetchedAt + QUERY_CACHE_TIME) {
+            cacheHits_ += 1;
+            return it->second.body;
+        }
+    }
+
+    if (cache_.size() >= QUERY_CACHE_ENTRIES) {
+        // expired entries go first, then everything that is not in flight
+        for (bool expiredOnly : {true, false}) {
+            for (auto entry = cache_.begin(); entry != cache_.end();) {
+                bool removable = entry->second.body.is_done() &&
+                                 (!expiredOnly || now >= entry->second.fetchedAt + QUERY_CACHE_TIME);
+                entry = removable ? cache_.erase(entry) : std::next(entry);
+            }
+            if (cache_.size() < QUERY_CACHE_ENTRIES) break;
+        }
+    }
+
+    storageReads_ += 1;
+    auto task = pplx::create_task(std::move(fetch));
+    cache_[key] = {task, now};
+    return task;
+}
+
+void QueryService::reportCheck() {
+    auto now = std::chrono::steady_clock::now();
+    if (now < lastReport_ + std::chrono::seconds(QUERY_REPORT_TIME)) return;
+    lastReport_ = now;
+
+    long long requests = requests_.exchange(0);
+    if (requests == 0) return;
+    std::cout << "Query service: " << requests << " requests, " << memoryHits_.exchange(0) << " from memory, "
+              << cacheHits_.exchange(0) << " cached, " << coalesced_.exchange(0) << " coalesced, "
+              << storageReads_.exchange(0) << " storage reads" << std::endl;
+}
@@ -0,0 +1,66 @@
+#ifndef QUERY_SERVICE_HPP
+#define QUERY_SERVICE_HPP
+
+#include <cpprest/http_listener.h>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include "Core/Database/HistoryReader.hpp"
+#include "Core/Market/MarketState.hpp"
+
+#define QUERY_CACHE_TIME 30 // in seconds
+#define QUERY_REPORT_TIME 60 // in seconds
+constexpr size_t QUERY_CACHE_ENTRIES = 256;
+constexpr int QUERY_DEFAULT_MINUTES = 60;
+constexpr int QUERY_MAX_MINUTES = 24 * 60;
+
+// Small HTTP/JSON endpoint for the controller and dashboards, so they stop
+// querying the node's database directly:
+//   GET /prices                              latest price of every symbol
+//   GET /chart?symbol=<api symbol>&minutes=N per-minute samples, N defaults to an hour
+//   GET /bars?symbol=<api symbol>&timeframe=<1d|1w|1m|1y>
+// Prices and loaded charts are answered from the published market snapshot.
+// Everything else goes through the HistoryReader; identical requests in
+// flight share one query and results are cached for QUERY_CACHE_TIME.
+class QueryService {
+public:
+    QueryService(const std::string& address, MarketState& market);
+
+    bool open();
+    void close();
+
+    // Storage thread: logs requests, cache hits and storage reads.
+    void reportCheck();
+
+private:
+    struct CacheEntry {
+        pplx::task<std::string> body;
+        long long fetchedAt = 0;
+    };
+
+    void handle(web::http::http_request request);
+    std::string pricesBody();
+    bool chartFromMemory(const std::string& apiSymbol, int minutes, std::string& body);
+    pplx::task<std::string> cached(const std::string& key, std::function<std::string()> fetch);
+
+    std::string address_;
+    web::http::experimental::listener::http_listener listener_;
+    MarketState& market_;
+    HistoryReader reader_;
+
+    std::unordered_map<std::string, CacheEntry> cache_;
+    std::mutex cacheMutex_;
+
+    // since the last report
+    std::atomic<long long> requests_ = 0;
+    std::atomic<long long> memoryHits_ = 0;
+    std::atomic<long long> cacheHits_ = 0;
+    std::atomic<long long> coalesced_ = 0;
+    std::atomic<long long> storageReads_ = 0;
+    std::chrono::steady_clock::time_point lastReport_;
+};
+
+#endif // QUERY_SERVICE_HPP
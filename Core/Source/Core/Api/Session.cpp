@@ -1,36 +1,29 @@
 #include <json/json.h>
-#include <cpprest/http_client.h>
-#include <cpprest/filestream.h>
-#include <cpprest/streams.h>
-#include <opencv2/opencv.hpp>
-#include <filesystem>
 #include <iostream>
 #include <thread>
 #include <chrono>
 #include <algorithm>
 #include <csignal>
 #include <mutex>
+#include <atomic>
+#include <unordered_set>
+#include <cmath>
 #include "Session.hpp"
+#include "Core/System/AllocationAudit.hpp"
 
 using namespace web::websockets::client;
-using namespace web::http::client;
-namespace fs = std::filesystem;
 
 namespace {
     // Constants
-    const std::string FINNHUB_URL = "wss://ws.finnhub.io/?token=";
-    const std::string LOGO_URL = "https://financialmodelingprep.com/image-stock/";
     const std::string CONTROL_URL = "wss://backend.stock-ticker-remote.link/ws?token="; 
 
-    int currentSymbolIndex_ = -1;
-    volatile long long lastUpdateTime = time(nullptr);
-    volatile bool interruptReceived = false;
-    long long nextSwitchTime = 0;
+    std::atomic<int> currentSymbolIndex_ = -1;
+    std::atomic<bool> interruptReceived = false;
+    std::atomic<long long> nextSwitchTime = 0;
 
-    bool receivedFirstUpdate = false;
+    std::atomic<bool> receivedFirstUpdate = false;
 
-    bool connectedToApi = false;
-    bool connectedToController = false;
+    std::atomic<bool> connectedToController = false;
     bool updatingConfig = false;    
 }
 
@@ -40,13 +33,79 @@ static void interruptHandler(int signo) {
     std::this_thread::sleep_for(std::chrono::seconds(2));
 }
 
-Session::Session() {
+Session::Session() : feeds_([this](const std::vector<Tick>& ticks, const std::string& prefix) {
+    if (!interruptReceived) {
+        processTicks(ticks, prefix);
+        // with a feed bus the daemon keeps the archive
+        if (config_->getTickArchive()) archiveTicks(ticks, prefix);
+    }
+}), market_(MATRIX_WIDTH) {
     std::signal(SIGTERM, interruptHandler);
     std::signal(SIGINT, interruptHandler);
 
-    // Initialize latest prices to MISSING_PRICE
-    for (const auto& symbol : config_->getApiSubsList()) {
-        latestPrices_[symbol] = MISSING_PRICE;
+    // several displays on one machine share the upstream connections of the feed daemon
+    if (!config_->getFeedBus().empty() && !clock_->isSimulated()) {
+        feedBus_ = std::make_unique<FeedBusClient>(config_->getFeedBus(), [this](const FeedBusMessage& message) {
+            if (!interruptReceived) {
+                processBusMessage(message);
+            }
+        });
+    }
+
+    setSymbols(config_->getSubsList(), config_->getApiSubsList(), config_->getLogoSubsList());
+    // a simulated day starts from an empty display and serves nobody
+    if (clock_->isSimulated()) return;
+
+    restoreWarmStart();
+
+    if (!config_->getQueryListen().empty()) {
+        queryService_ = std::make_unique<QueryService>(config_->getQueryListen(), market_);
+    }
+}
+
+void Session::setSymbols(const std::vector<std::string>& subs,
+                         const std::vector<std::string>& apiSubs,
+                         const std::vector<std::string>& logoSubs) {
+    market_.setSymbols(subs, apiSubs, logoSubs);
+
+    std::map<MarketHours, int> symbolsByHours;
+    for (const auto& apiSymbol : apiSubs) {
+        symbolsByHours[calendar_->hoursOf(apiSymbol)] += 1;
+    }
+    std::lock_guard<std::mutex> lock(symbolsByHoursMutex_);
+    symbolsByHours_.swap(symbolsByHours);
+}
+
+void Session::restoreWarmStart() {
+    WarmStartState warmStart;
+    if (!WarmStart::load(WARM_START_FILE, warmStart)) return;
+
+    // Controller mode starts without a watchlist, show the last one until the controller sends its config
+    if (config_->getApiSubsList().empty() && !warmStart.apiSubs.empty()) {
+        config_->setSubsList(warmStart.subs);
+        config_->setApiSubsList(warmStart.apiSubs);
+        config_->setLogoSubsList(warmStart.logoSubs);
+        config_->setSwitchTime(warmStart.switchTime);
+        setSymbols(warmStart.subs, warmStart.apiSubs, warmStart.logoSubs);
+    }
+
+    for (const auto& [path, sprite] : warmStart.sprites) {
+        LogoCache::getInstance()->put(path, sprite);
+    }
+
+    // symbols no longer in the watchlist are ignored by the market state
+    for (const auto& symbol : warmStart.symbols) {
+        market_.restoreHistory(symbol.apiName, *symbol.chart, symbol.lastStoredPrice, symbol.referencePrice);
+    }
+}
+
+void Session::warmStartSaveCheck() {
+    if (clock_->now() < nextWarmStartSaveTime_) return;
+    nextWarmStartSaveTime_ = clock_->now() + WARM_START_SAVE_TIME;
+
+    auto snapshot = market_.snapshot();
+    if (!snapshot->symbols.empty()) {
+        WarmStart::save(WARM_START_FILE, *snapshot, config_->getSwitchTime());
     }
 }
 
@@ -54,73 +113,126 @@ void Session::chooseConfigAndSubscribe() {
     if (!config_->getControlToken().empty()) {
         controllerSubscribe();
     } else {
-        subscribe();
+        subscribeFeeds(config_->getApiSubsList());
+        feedCheck();
         saveLogos();
     }
 }
 
-void Session::subscribe() {
-    try {
-        std::cout << "Creating new client..." << std::endl;
-        client_ = std::make_unique<websocket_callback_client>();
-    
-        client_->connect(U(FINNHUB_URL + config_->getToken())).wait();
-        connectedToApi = true;
-
-        client_->set_message_handler([this](websocket_incoming_message msg) {
-            if (!interruptReceived) {
-                msg.extract_string().then([this](std::string msg) {
-                    std::cout << "Received Message: " << msg << std::endl;
-                    processMessage(msg);
-                }).wait();
-            }
-        });
-
-        client_->set_close_handler([this](websocket_close_status closeStatus, const utility::string_t& reason, const std::error_code& error) {
-            if (!reason.empty()) {
-                std::cout << "WebSocket Closed: " << reason << std::endl;
-            } else {
-                std::cout << "WebSocket Closed with no reason provided." << std::endl;
-            }
-            connectedToApi = false;
-        });
+void Session::subscribeFeeds(const std::vector<std::string>& apiSymbols) {
+    if (feedBus_) {
+        feedBus_->setSymbols(apiSymbols);
+    } else {
+        feeds_.setSymbols(apiSymbols);
+    }
+}
 
-        std::cout << "Subscribing to symbols..." << std::endl;
-        for (const auto& symbol : config_->getApiSubsList()) {
-            subscribeToSymbol(symbol);
+void Session::feedCheck() {
+    if (feedBus_) {
+        feedBus_->check();
+        // bars were missed while the daemon was away, the charts are refetched
+        if (feedBus_->takeReconnected()) {
+            market_.clearHistory();
         }
-    } catch (const std::exception& e) {
-        std::cerr << "Exception occurred: " << e.what() << std::endl;
-        std::this_thread::sleep_for(std::chrono::seconds(3));
+        return;
     }
+
+    feeds_.check();
+
+    long long now = clock_->now();
+    if (now < nextStaleCheckTime_) return;
+    nextStaleCheckTime_ = now + STALE_SYMBOL_TIME;
+
+    feeds_.resubscribe(market_.staleSymbols(now, STALE_SYMBOL_TIME));
 }
 
-void Session::disconnect() {
-    std::cout << "Disconnecting..." << std::endl;
-    std::cout << "Closing the old client connection..." << std::endl;
+void Session::processTicks(const std::vector<Tick>& ticks, const std::string& prefix) {
+    // reused per feed thread, a message carries a handful of symbols
+    thread_local std::vector<std::string_view> parsedSymbols;
+    thread_local std::string apiSymbol;
+    parsedSymbols.clear();
+    for (const auto& tick : ticks) {
+        apiSymbol.assign(prefix).append(tick.symbol);
+
+        // alerts see every trade, the display only needs one price per message
+        alerts_.onTick(apiSymbol, tick.price, tick.time);
+        if (std::find(parsedSymbols.begin(), parsedSymbols.end(), tick.symbol) != parsedSymbols.end()) continue;
+
+        market_.updatePrice(apiSymbol, tick.price, tick.time);
+        parsedSymbols.push_back(tick.symbol);
+    }
+
+    if (!receivedFirstUpdate) receivedFirstUpdate = true;
+}
 
-    if (client_) {
-        client_->close().wait(); // Use wait to ensure close operation completes
-        client_.reset();
-        std::cout << "Closed the old client connection..." << std::endl;
+void Session::archiveTicks(const std::vector<Tick>& ticks, const std::string& prefix) {
+    thread_local std::string apiSymbol;
+    for (const auto& tick : ticks) {
+        apiSymbol.assign(prefix).append(tick.symbol);
+        archive_.append(apiSymbol, tick.tradeTime != 0 ? tick.tradeTime : tick.time * 1000, tick.price);
     }
+}
 
-    connectedToApi = false;
+void Session::processBusMessage(const FeedBusMessage& message) {
+    if (message.type == FeedBusType::Tick) {
+        thread_local std::vector<Tick> ticks(1);
+        ticks[0] = Tick{feedBusSymbol(message), message.price, message.time};
+        processTicks(ticks, "");
+    } else if (message.type == FeedBusType::Bar) {
+        std::lock_guard<std::mutex> lock(barsMutex_);
+        pendingBars_.emplace_back(std::string(feedBusSymbol(message)), message.price);
+    }
 }
 
 void Session::disconnectController() {
     std::cout << "Disconnecting from remote controller..." << std::endl;
     std::cout << "Closing the old remote client connection..." << std::endl;
 
-    if (client_) {
-        controllerClient_->close().wait(); // Use wait to ensure close operation completes
+    if (controllerClient_) {
+        // closed in the background, the client is kept alive until the close completes
+        closeController(std::move(controllerClient_));
         controllerClient_.reset();
-        std::cout << "Closed the old remote client connection..." << std::endl;
     }
 
     connectedToController = false;
 }
 
+AsyncTask Session::closeController(std::shared_ptr<websocket_callback_client> client) {
+    try {
+        co_await awaitTask(executor_, client->close());
+        std::cout << "Closed the old remote client connection..." << std::endl;
+    } catch (const std::exception& e) {
+        std::cerr << "Exception occurred: " << e.what() << std::endl;
+    }
+}
+
+// [{"id": "...", "symbol": "<api name>", "type": "above|below|cross|percent", "value": 0, "debounce": 300}]
+std::vector<AlertRule> jsonToAlertRules(const Json::Value& jsonArray) {
+    std::vector<AlertRule> rules;
+    for (const auto& item : jsonArray) {
+        std::string type = item["type"].asString();
+        AlertRule rule;
+        if (type == "above") {
+            rule.type = AlertType::Above;
+        } else if (type == "below") {
+            rule.type = AlertType::Below;
+        } else if (type == "cross") {
+            rule.type = AlertType::Cross;
+        } else if (type == "percent") {
+            rule.type = AlertType::PercentMove;
+        } else {
+            std::cerr << "Ignoring alert with unknown type: " << type << std::endl;
+            continue;
+        }
+        rule.id = item["id"].asString();
+        rule.apiSymbol = item["symbol"].asString();
+        rule.value = item["value"].asDouble();
+        rule.debounce = item.get("debounce", ALERT_DEFAULT_DEBOUNCE).asInt();
+        rules.push_back(rule);
+    }
+    return rules;
+}
+
 std::vector<std::string> jsonArrayToVector(const Json::Value& jsonArray) {
     std::vector<std::string> vec;
     for (const auto& item : jsonArray) {
@@ -132,8 +244,6 @@ std::vector<std::string> jsonArrayToVector(const Json::Value& jsonArray) {
 }
 
 void Session::configUpdate(const std::string& config) {
-    std::lock_guard<std::mutex> lock(priceConfigMutex); 
-
     Json::Value root;
     Json::Reader reader;
     if (!reader.parse(config, root) || root["type"].asString() != "config") {
@@ -159,9 +269,6 @@ void Session::configUpdate(const std::string& config) {
         config_->getApiSubsList() != apiSubsList;
 
     if ( updateSubs ) {
-        disconnect();
-        clearPriceHistory();
-
         if (configId != root["id"].asInt()) {
             currentSymbolIndex_ = -1;
             nextSwitchTime = 0;
@@ -181,233 +288,635 @@ void Session::configUpdate(const std::string& config) {
         saveLogos();
     }
 
+    if (updateSubs || updateLogos) {
+        setSymbols(config_->getSubsList(), config_->getApiSubsList(), config_->getLogoSubsList());
+    }
+
     if (updateSubs) {
-        subscribe();
+        subscribeFeeds(config_->getApiSubsList());
         updatingConfig = false;
     }
 
+    if (root.isMember("alerts")) {
+        alerts_.setRules(jsonToAlertRules(root["alerts"]));
+    }
+
     if (firstRun) {
         firstRun = false;
     }
 }
 
-void Session::controllerSubscribe() {
+AsyncTask Session::controllerSubscribe() {
     std::cout << "Subscribing controller app..." << std::endl;
+    connectingToController_ = true;
+    int generation = ++controllerGeneration_;
     try {
         // websocket_client_config config;
         // config.set_validate_certificates(false); // Disable certificate validation
-        controllerClient_ = std::make_unique<websocket_callback_client>();
+        controllerClient_ = std::make_shared<websocket_callback_client>();
 
         controllerClient_->set_message_handler([this](websocket_incoming_message msg) {
             if (!interruptReceived) {
-                msg.extract_string().then([this](std::string body) {
-                    std::cout << "Received message: " << body << std::endl;
-                    configUpdate(body);
-                }).wait();
+                receiveControllerMessage(msg);
             }
         });
 
-        controllerClient_->set_close_handler([](websocket_close_status status, const utility::string_t& reason, const std::error_code& error) {
+        controllerClient_->set_close_handler([this, generation](websocket_close_status status, const utility::string_t& reason, const std::error_code& error) {
             std::cout << "Connection closed: " << reason << std::endl;
-            connectedToController = false;
+            if (generation == controllerGeneration_) {
+                connectedToController = false;
+            }
         });
 
         std::string uri = CONTROL_URL + config_->getControlToken();
-        controllerClient_->connect(U(uri)).then([uri] {
-            std::cout << "Connecting to: " << U(uri) << std::endl;
-        }).wait();
+        std::cout << "Connecting to: " << U(uri) << std::endl;
+        co_await awaitTask(executor_, controllerClient_->connect(U(uri)));
 
         connectedToController = true;
+        controllerBackoff_.succeeded();
     } catch (const std::exception& e) {
         std::cerr << "Exception occurred: " << e.what() << std::endl;
+        auto delay = controllerBackoff_.failed(std::chrono::steady_clock::now());
+        std::cout << "Retrying remote controller in " << delay.count() << "ms" << std::endl;
     }
+    connectingToController_ = false;
 }
 
-void Session::clearPriceHistory() {
-    renderer_.clearPastCharts();
-    for (const auto& symbol : config_->getApiSubsList()) {
-        latestPrices_[symbol] = MISSING_PRICE;
-    }
+AsyncTask Session::receiveControllerMessage(websocket_incoming_message msg) {
+    // resumed on the network thread, the config is applied there directly
+    std::string body = co_await awaitTask(executor_, msg.extract_string());
+    std::cout << "Received message: " << body << std::endl;
+    configUpdate(body);
 }
 
 void Session::priceUpdateCheck() {
     if (!receivedFirstUpdate) return;
 
+    if (feedBus_) {
+        busBarCheck();
+        return;
+    }
+
+    // nothing trades overnight, and samples missed then must not refetch the charts every minute
+    if (openSymbols_ == 0) return;
+
     int secondsSinceLastUpdate = dataStorage_->secondsSinceLastUpdate();
     if (secondsSinceLastUpdate == std::numeric_limits<int>::max()) {
         secondsSinceLastUpdate = PRICE_TIME_INTERVAL;
     }
-    
 
     bool savePrice = (secondsSinceLastUpdate >= PRICE_TIME_INTERVAL &&
                      (secondsSinceLastUpdate % PRICE_TIME_INTERVAL) < ALLOWABLE_DISSYNCHRONIZATION_TIME);
 
-    if ( savePrice && secondsSinceLastUpdate >= PRICE_TIME_INTERVAL*2 ) {
-        renderer_.clearPastCharts();
+    if (!savePrice) return;
+
+    // samples were missed, the charts are refetched instead of appended to
+    if (secondsSinceLastUpdate >= PRICE_TIME_INTERVAL*2) {
+        market_.clearHistory();
     }
 
     std::cout << "Seconds since last update: " << secondsSinceLastUpdate << std::endl;
-    for (const auto& symbol : config_->getApiSubsList()) {
-        double price = latestPrices_[symbol];
-        if (savePrice) {
-            if (price != MISSING_PRICE) {
-                dataStorage_->savePrice(symbol, price);
-                std::cout << "Saved price: " << symbol << " " << price << std::endl;
+
+    // the cold tier catches up once per sample, then every symbol is stored in one batch
+    market_.flushPrices();
+    auto snapshot = market_.snapshot();
+    long long now = clock_->now();
+    std::vector<std::pair<std::string, double>> prices;
+    for (const auto& symbol : snapshot->symbols) {
+        if (symbol.price != MISSING_PRICE && calendar_->isOpen(symbol.apiName, now)) {
+            prices.emplace_back(symbol.apiName, symbol.price);
+        }
+    }
+    dataStorage_->savePrices(prices);
+    std::cout << "Saved prices: " << prices.size() << std::endl;
+
+    for (const auto& symbol : snapshot->symbols) {
+        // closed symbols keep the chart of their last session
+        if (!calendar_->isOpen(symbol.apiName, now)) continue;
+
+        if (symbol.hot && symbol.price != MISSING_PRICE) {
+            std::cout << "Saved price: " << symbol.apiName << " " << symbol.price;
+            if (symbol.indicators && !symbol.indicators->empty() && symbol.indicators->back().rsi != MISSING_PRICE) {
+                std::cout << ", RSI " << std::round(symbol.indicators->back().rsi * 10) / 10;
             }
-            // latestPrices_[symbol] = MISSING_PRICE;
+            std::cout << std::endl;
         }
-        render(symbol, price, savePrice, false);
+        market_.appendSample(symbol.apiName, symbol.price);
     }
 }
 
-void Session::runForever() {
-    // If using controller api, spin and wait for config update:
-    while(config_->getApiSubsList().size() == 0 || config_->getLogoSubsList().size() == 0) {
-        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+// The feed daemon already stored these prices, they only extend the charts here.
+void Session::busBarCheck() {
+    std::vector<std::pair<std::string, double>> bars;
+    {
+        std::lock_guard<std::mutex> lock(barsMutex_);
+        bars.swap(pendingBars_);
     }
+    if (bars.empty()) return;
 
-    while (!interruptReceived) {
-        if (priceConfigMutex.try_lock()) {
-            if (!connectedToApi || time(NULL) > lastUpdateTime + 20) {
-                std::cout << "Reconnecting..." << std::endl;
-                disconnect();
-                subscribe();
-                if (time(NULL) > lastUpdateTime + 20){
-                    lastUpdateTime = time(NULL);
-                }
-            }
+    market_.flushPrices();
+    for (const auto& [apiSymbol, price] : bars) {
+        market_.appendSample(apiSymbol, price);
+    }
+    std::cout << "Received bars: " << bars.size() << std::endl;
+}
 
-            if (!connectedToController) {
-                std::cout << "Reconnecting to remote controller..." << std::endl;
-                disconnectController();
-                controllerSubscribe();
-            }
+// Counts the symbols whose market is open, every session thread scales its work by it.
+// The calendar is asked once per kind of trading hours, not per symbol.
+void Session::marketHoursCheck() {
+    long long now = clock_->now();
+    int open = 0;
+    int symbols = 0;
+    {
+        std::lock_guard<std::mutex> lock(symbolsByHoursMutex_);
+        for (const auto& [hours, count] : symbolsByHours_) {
+            symbols += count;
+            if (calendar_->isOpen(hours, now)) open += count;
+        }
+    }
 
-            priceUpdateCheck();
-            
-            primarySymbolSwitchCheck();
+    if (open != openSymbols_.exchange(open)) {
+        std::cout << "Markets open for " << open << " of " << symbols << " symbols" << std::endl;
+    }
+}
+
+void Session::historyLoadCheck() {
+    long long now = clock_->now();
+
+    // hot symbols first, and a bounded number of loads and checks per pass however long the watchlist
+    auto loads = market_.historyLoads(HISTORY_LOADS_PER_CHECK, HISTORY_SCANS_PER_CHECK, [this, now](const SymbolSnapshot& symbol) {
+        const Timeframe& timeframe = findTimeframe(config_->getChartTimeframe(symbol.apiName));
+        bool live = timeframe.table.empty();
+        // rollup charts move once per bucket, they are reloaded instead of appended to
+        return symbol.liveChart != live || (!live && now >= symbol.historyLoadedAt + timeframe.bucket);
+    });
+
+    for (const auto& apiSymbol : loads) {
+        const Timeframe& timeframe = findTimeframe(config_->getChartTimeframe(apiSymbol));
+        bool live = timeframe.table.empty();
+
+        std::optional<std::deque<double>> chart;
+        if (live) {
+            chart = dataStorage_->getPriceHistory(apiSymbol, MATRIX_WIDTH);
+        } else if (auto points = dataStorage_->getRollupHistory(apiSymbol, timeframe.table, timeframe.span)) {
+            // the live price takes the rightmost column
+            chart = downsampleLttb(*points, MATRIX_WIDTH - 1);
+        }
+        auto referencePrice = dataStorage_->closedMarketPrice(apiSymbol);
+        auto lastPrice = dataStorage_->getLastPrice(apiSymbol);
+
+        // without the database the warm start chart stays, and the symbol is loaded again next pass
+        if (!chart || !referencePrice || !lastPrice) break;
+
+        market_.setHistory(apiSymbol,
+                           std::move(*chart),
+                           *lastPrice,
+                           *referencePrice,
+                           live);
+        alerts_.setReference(apiSymbol, *referencePrice);
+    }
+}
 
-            priceConfigMutex.unlock();
-        } 
+void Session::runForever() {
+    if (queryService_ && !queryService_->open()) {
+        queryService_.reset();
     }
 
-    if (client_) {
-        client_->close().wait(); // Ensure the client closes gracefully
+    renderThread_ = std::thread(&Session::renderLoop, this);
+    sceneThread_ = std::thread(&Session::sceneLoop, this);
+    storageThread_ = std::thread(&Session::storageLoop, this);
+    networkThread_ = std::thread(&Session::networkLoop, this);
+
+    renderThread_.join();
+    sceneThread_.join();
+    storageThread_.join();
+    networkThread_.join();
+
+    feeds_.reset();
+    if (feedBus_) {
+        feedBus_->close();
+    }
+    archive_.close();
+    if (queryService_) {
+        queryService_->close();
     }
     std::cout << "Session stopped" << std::endl;
 }
 
-void Session::primarySymbolSwitchCheck() {
-    if (time(nullptr) > nextSwitchTime) {
-        currentSymbolIndex_ = (currentSymbolIndex_ + 1) % config_->getApiSubsList().size();
-        std::string symbol = config_->getApiSubsList()[currentSymbolIndex_];
-        double price = latestPrices_[config_->getApiSubsList()[currentSymbolIndex_]];
-        render(symbol, price, false, true);
-        nextSwitchTime = time(nullptr) + config_->getSwitchTime();
+bool Session::runSimulation(const SimulationScript& script) {
+    if (script.trades().empty()) return false;
+
+    dataStorage_->clearSimulation();
+    renderThread_ = std::thread(&Session::renderLoop, this);
+
+    // the storage checks run once per simulated STORAGE_CHECK_TIME, as the storage thread would
+    auto startTime = std::chrono::steady_clock::now();
+    std::vector<Tick> ticks(1);
+    long long nextStorageCheckTime = script.start();
+    long long trades = 0;
+    for (const auto& trade : script.trades()) {
+        if (interruptReceived) break;
+
+        while (trade.time >= nextStorageCheckTime) {
+            clock_->advanceTo(nextStorageCheckTime);
+            marketHoursCheck();
+            priceUpdateCheck();
+            historyLoadCheck();
+            nextStorageCheckTime += STORAGE_CHECK_TIME * 1000;
+        }
+
+        // caches and pools have grown to their working size once the first samples are stored
+        if (trade.time >= script.start() + SIMULATION_WARM_UP * 1000LL) {
+            AllocationAudit::arm();
+        }
+
+        clock_->advanceTo(trade.time);
+        {
+            // a trade is handled like one from a feed message, without allocating
+            AllocationScope scope("simulated trade");
+            ticks[0] = Tick{trade.apiSymbol, trade.price, trade.time / 1000, trade.time};
+            processTicks(ticks, "");
+        }
+        trades += 1;
+    }
+
+    clock_->advanceTo(nextStorageCheckTime);
+    marketHoursCheck();
+    priceUpdateCheck();
+
+    auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+    double simulated = (clock_->nowMilliseconds() - script.start()) / 1000.0;
+    std::cout << "Simulated " << trades << " trades over " << simulated << "s in " << elapsed << "s"
+              << ", " << static_cast<long long>(trades / std::max(elapsed, 1e-6)) << " trades/s"
+              << ", " << static_cast<long long>(simulated / std::max(elapsed, 1e-6)) << "x real time" << std::endl;
+
+    bool passed = simulationCheck(script);
+
+    interruptReceived = true;
+    renderThread_.join();
+
+    if (AllocationAudit::enabled()) {
+        AllocationAudit::report();
+        if (AllocationAudit::violations() > 0) {
+            std::cerr << "Simulation failed: " << AllocationAudit::violations() << " steady-state scopes allocated" << std::endl;
+            passed = false;
+        }
     }
+    std::cout << "Simulation " << (passed ? "passed" : "failed") << std::endl;
+    return passed;
 }
 
-void Session::render(std::string symbol, double price, bool savePrice, bool fully){
-    if (fully) {
-        renderer_.renderEntireSymbol(currentSymbolIndex_, latestPrices_[config_->getApiSubsList()[currentSymbolIndex_]]);
-    } else {
-        bool isPrimarySymbol = config_->getApiSubsList()[currentSymbolIndex_] == symbol;
-        if (isPrimarySymbol) {
-            renderer_.renderPrice(symbol, price);
-            renderer_.renderGain(symbol, price);
+// The clock is simulated from the start of the range, the live history is
+// only read through its own connection and nothing is stored meanwhile.
+void Session::runPlayback(long long from, long long to, double speed, const std::string& timeframe) {
+    const std::string& table = timeframe.empty() ? DB_TABLE : findTimeframe(timeframe).table;
+    std::string source = table.empty() ? DB_TABLE : table;
+
+    renderThread_ = std::thread(&Session::renderLoop, this);
+    sceneThread_ = std::thread(&Session::sceneLoop, this);
+
+    // one reference per symbol, the gain runs from the start of the range
+    std::unordered_set<std::string> started;
+    std::vector<Tick> ticks(1);
+    long long samples = 0;
+    long long previousTime = 0;
+    auto start = std::chrono::steady_clock::now();
+    HistoryReader reader;
+
+    std::cout << "Playing back " << source << " from " << from << " to " << to << " at " << speed << "x" << std::endl;
+    bool streamed = reader.stream(source, config_->getApiSubsList(), from, to, PLAYBACK_CHUNK_SIZE,
+                                  [&](long long time, const std::string& apiSymbol, double price) {
+        if (!playbackWait(start, from * 1000, speed, time)) return false;
+
+        // the cold tier catches up once per sample, like the storage thread does
+        if (time != previousTime) {
+            market_.flushPrices();
+            previousTime = time;
+        }
+        if (started.insert(apiSymbol).second) {
+            market_.setHistory(apiSymbol, {}, price, price);
+            alerts_.setReference(apiSymbol, price);
         }
-        renderer_.updateChart(symbol, price, savePrice, isPrimarySymbol);
+
+        ticks[0] = Tick{apiSymbol, price, time / 1000, time};
+        processTicks(ticks, "");
+        market_.appendSample(apiSymbol, price);
+        samples += 1;
+        return true;
+    });
+    if (streamed) {
+        playbackWait(start, from * 1000, speed, to * 1000);
     }
+
+    auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "Played back " << samples << " samples of " << started.size() << " symbols in " << elapsed << "s" << std::endl;
+
+    interruptReceived = true;
+    renderThread_.join();
+    sceneThread_.join();
+    std::cout << "Playback stopped" << std::endl;
 }
 
-void Session::subscribeToSymbol(const std::string& symbol) {
-    std::cout << "Subscribing to symbol " << symbol << std::endl;
-    websocket_outgoing_message msg;
-    msg.set_utf8_message("{\"type\":\"subscribe\",\"symbol\":\"" + symbol + "\"}");
-    client_->send(msg).wait();
+// Moves the clock along with the wall time until the playback reaches the given time in milliseconds.
+bool Session::playbackWait(std::chrono::steady_clock::time_point start, long long from, double speed, long long until) {
+    while (!interruptReceived) {
+        auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+        long long playbackTime = from + static_cast<long long>(elapsed * speed);
+        clock_->advanceTo(std::min(playbackTime, until));
+        if (playbackTime >= until) return true;
+
+        auto remaining = static_cast<long long>((until - playbackTime) / speed);
+        std::this_thread::sleep_for(std::chrono::milliseconds(std::clamp<long long>(remaining, 1, PLAYBACK_CHECK_TIME)));
+    }
+    return false;
 }
 
-void Session::processMessage(const std::string& update) {
-    Json::Value root;
-    Json::Reader reader;
-    if (!reader.parse(update, root)) {
-        std::cout << "Error parsing JSON" << std::endl;
-        return;
+// Every stored sample must hold the last trade before it, one per PRICE_TIME_INTERVAL while the market was open.
+bool Session::simulationCheck(const SimulationScript& script) {
+    long long from = script.start() / 1000;
+    long long to = clock_->now();
+    int samples = 0;
+    int mismatches = 0;
+    int gaps = 0;
+
+    for (const auto& apiSymbol : config_->getApiSubsList()) {
+        long long previousTime = 0;
+        for (const auto& [time, price] : dataStorage_->getSamples(apiSymbol, from, to)) {
+            samples += 1;
+            double expected = script.priceBefore(apiSymbol, time * 1000);
+            if (std::abs(price - expected) > 1e-6 * std::max(1.0, std::abs(expected))) {
+                mismatches += 1;
+                if (mismatches <= 10) {
+                    std::cerr << "Sample of " << apiSymbol << " at " << time << " is " << price << ", expected " << expected << std::endl;
+                }
+            }
+            if (previousTime != 0 && calendar_->isOpen(apiSymbol, time) &&
+                time - previousTime >= PRICE_TIME_INTERVAL + ALLOWABLE_DISSYNCHRONIZATION_TIME) {
+                gaps += 1;
+            }
+            previousTime = time;
+        }
     }
 
-    if (root["type"].asString() == "ping") {
-        std::cout << "Received ping" << std::endl;
-        return;
+    std::cout << "Checked " << samples << " stored samples: " << mismatches << " mismatched prices, "
+              << gaps << " missed intervals" << std::endl;
+    return samples > 0 && mismatches == 0 && gaps == 0;
+}
+
+void Session::renderLoop() {
+    ThreadPlacement::getInstance()->apply(RENDER_THREAD_ROLE);
+
+    bool marquee = config_->getDisplayMode() == MARQUEE_DISPLAY_MODE;
+    bool layout = renderer_.hasLayout();
+    if (config_->getDisplayMode() == LAYOUT_DISPLAY_MODE && !layout) {
+        std::cerr << "Layout has no widgets, switching between symbols instead" << std::endl;
     }
+    const auto frameBudget = std::chrono::microseconds(1000000 / (marquee ? MARQUEE_FPS : RENDER_FPS));
+    const auto lowActivityBudget = std::chrono::microseconds(1000000 / LOW_ACTIVITY_FPS);
 
-    if (root["type"].asString() == "trade") {
-        lastUpdateTime = time(nullptr);
-        std::cout << "Received trade" << std::endl;
+    auto startTime = std::chrono::steady_clock::now();
+    auto nextFrameTime = startTime;
+    auto nextReportTime = startTime + std::chrono::seconds(RENDER_REPORT_TIME);
+    long long frames = 0;
+    auto worstFrame = std::chrono::steady_clock::duration::zero();
 
-        std::set<std::string> parsedSymbols;
-        if (root["data"].isArray()) {
-            for (const auto& trade : root["data"]) {
-                std::string symbol = trade["s"].asString();
-                if (parsedSymbols.find(symbol) != parsedSymbols.end()) continue;
+    while (!interruptReceived) {
+        auto frameStart = std::chrono::steady_clock::now();
+
+        {
+            AllocationScope scope("render frame");
+            auto snapshot = market_.snapshot();
+            if (!snapshot->symbols.empty()) {
+                alertCheck(*snapshot, marquee);
+                if (marquee) {
+                    marqueeCheck(*snapshot, frameStart - startTime);
+                } else if (layout) {
+                    layoutCheck(*snapshot);
+                } else {
+                    primarySymbolSwitchCheck(*snapshot);
+                    alertFlashCheck(*snapshot);
+                }
+            }
+        }
 
-                double price = trade["p"].asDouble();
-                if (price == 0) continue;
+        auto frameEnd = std::chrono::steady_clock::now();
+        auto frameTime = frameEnd - frameStart;
+        worstFrame = std::max(worstFrame, frameTime);
+        frames += 1;
+        if (frameTime > frameBudget) {
+            frameOverruns_ += 1;
+        }
 
-                latestPrices_[symbol] = price;
-                parsedSymbols.insert(symbol);
+        if (frameEnd >= nextReportTime) {
+            std::cout << "Rendered frames: " << frames
+                      << ", overruns: " << frameOverruns_
+                      << ", worst frame: " << std::chrono::duration_cast<std::chrono::microseconds>(worstFrame).count() << "us" << std::endl;
+            if (switches_ > 0) {
+                std::cout << "Symbol switches: " << switches_
+                          << ", scene misses: " << sceneMisses_
+                          << ", average switch: " << std::chrono::duration_cast<std::chrono::microseconds>(switchLatency_).count() / switches_ << "us"
+                          << ", worst switch: " << std::chrono::duration_cast<std::chrono::microseconds>(worstSwitchLatency_).count() << "us" << std::endl;
             }
+            alerts_.report();
+            AllocationAudit::report();
+            // caches, pools and buffers have grown to their working size by the first report
+            AllocationAudit::arm();
+            worstFrame = std::chrono::steady_clock::duration::zero();
+            worstSwitchLatency_ = std::chrono::steady_clock::duration::zero();
+            nextReportTime = frameEnd + std::chrono::seconds(RENDER_REPORT_TIME);
         }
-        parsedSymbols.clear();
 
-        if (!receivedFirstUpdate) receivedFirstUpdate = true;
+        // fixed frame rate, frames are dropped instead of bursting when behind. A closed
+        // market on screen does not change, it only has to switch and flash alerts in time.
+        bool lowActivity = !marquee && primaryClosed_ && alertSymbol_.empty();
+        auto budget = lowActivity ? lowActivityBudget : frameBudget;
+        nextFrameTime += budget;
+        if (nextFrameTime < frameEnd) {
+            nextFrameTime = frameEnd + budget;
+        }
+        std::this_thread::sleep_until(nextFrameTime);
     }
 }
 
-pplx::task<void> Session::fetchLogo(const std::string& logo) {
-    std::string url = LOGO_URL + logo + LOGO_EXT;
-    http_client client(url);
+void Session::sceneLoop() {
+    // switch mode only, marquee segments and layout widgets are kept current by the render thread
+    if (config_->getDisplayMode() == MARQUEE_DISPLAY_MODE || renderer_.hasLayout()) return;
+    ThreadPlacement::getInstance()->apply(SCENE_THREAD_ROLE);
 
-    return client.request(web::http::methods::GET).then([logo](web::http::http_response response) {
-        if (response.status_code() == web::http::status_codes::OK) {
-            try {
-                Concurrency::streams::fstream::open_ostream(LOGO_DIR + "/" + logo + LOGO_EXT).then([response](Concurrency::streams::ostream output) {
-                    return response.body().read_to_end(output.streambuf());
-                }).then([](size_t) {
-                    std::cout << "Logo downloaded successfully.\n";
-                }).wait();
-            } catch (const std::exception& e) {
-                std::cerr << "Exception writing file: " << e.what() << "\n";    
-            }
+    while (!interruptReceived) {
+        sceneCache_.refresh(*market_.snapshot());
+        std::this_thread::sleep_for(std::chrono::milliseconds(SCENE_CHECK_TIME));
+    }
+}
+
+void Session::storageLoop() {
+    ThreadPlacement::getInstance()->apply(STORAGE_THREAD_ROLE);
+
+    while (!interruptReceived) {
+        marketHoursCheck();
+        priceUpdateCheck();
+        dataStorage_->replayCheck();
+        historyLoadCheck();
+        warmStartSaveCheck();
+        compactor_.step();
+        archive_.flush();
+        if (queryService_) {
+            queryService_->reportCheck();
+        }
+        ThreadPlacement::getInstance()->reportCheck();
+        std::this_thread::sleep_for(std::chrono::seconds(STORAGE_CHECK_TIME));
+    }
+}
+
+void Session::networkLoop() {
+    ThreadPlacement::getInstance()->apply(INGEST_THREAD_ROLE);
+
+    // connecting happens here so the render thread can paint the warm start right away
+    chooseConfigAndSubscribe();
+
+    while (!interruptReceived) {
+        // If using controller api, wait for config update before connecting
+        if (config_->getApiSubsList().size() > 0 && config_->getLogoSubsList().size() > 0) {
+            feedCheck();
+        }
+
+        if (!connectedToController && !connectingToController_ && controllerBackoff_.ready(std::chrono::steady_clock::now())) {
+            std::cout << "Reconnecting to remote controller..." << std::endl;
+            disconnectController();
+            controllerSubscribe();
+        }
+
+        // coroutines waiting on the controller and logo downloads continue here in between
+        executor_.runFor(std::chrono::milliseconds(NETWORK_CHECK_TIME));
+    }
+}
+
+void Session::primarySymbolSwitchCheck(const MarketSnapshot& snapshot) {
+    int symbolsCount = snapshot.symbols.size();
+    int index = currentSymbolIndex_;
+
+    if (clock_->now() > nextSwitchTime || index < 0 || index >= symbolsCount) {
+        index = (std::max(index, -1) + 1) % symbolsCount;
+        currentSymbolIndex_ = index;
+        const SymbolSnapshot& symbol = snapshot.symbols[index];
+
+        auto switchStart = std::chrono::steady_clock::now();
+        auto scene = sceneCache_.find(symbol.apiName);
+        if (scene) {
+            renderer_.renderScene(*scene, symbol);
+            // chart drawn from older data is brought up to date on the next frame
+            bool current = scene->chart == symbol.chart && scene->price == symbol.price;
+            renderedVersion_ = current ? symbol.version : -1;
         } else {
-            std::cout << "Failed to download logo. Status code: " << response.status_code() << "\n";
+            renderer_.renderEntireSymbol(symbol);
+            renderedVersion_ = symbol.version;
+            sceneMisses_ += 1;
         }
-    });
+        auto latency = std::chrono::steady_clock::now() - switchStart;
+        switches_ += 1;
+        switchLatency_ += latency;
+        worstSwitchLatency_ = std::max(worstSwitchLatency_, latency);
+
+        nextSwitchTime = clock_->now() + config_->getSwitchTime();
+        primaryClosed_ = !calendar_->isOpen(symbol.apiName, clock_->now());
+
+        // the symbol on screen and the next ones up get every trade and a pre-rendered scene
+        hotSymbols_.clear();
+        for (int i = 0; i <= HOT_SYMBOLS_AHEAD && i < symbolsCount; i += 1) {
+            hotSymbols_.push_back(snapshot.symbols[(index + i) % symbolsCount].apiName);
+        }
+        market_.setHotSymbols(hotSymbols_);
+        return;
+    }
+
+    // redraw the dynamic parts only when the primary symbol changed
+    const SymbolSnapshot& symbol = snapshot.symbols[index];
+    if (symbol.version != renderedVersion_) {
+        renderer_.renderSymbolUpdate(symbol);
+        renderedVersion_ = symbol.version;
+    }
 }
 
-void Session::saveLogos() {
-    fs::path logosPath{LOGO_DIR};
+void Session::alertCheck(const MarketSnapshot& snapshot, bool marquee) {
+    for (const auto& alert : alerts_.takeFired()) {
+        std::cout << "Alert " << alert.id << ": " << alert.apiSymbol << " at " << alert.price << std::endl;
+        if (marquee) continue;
 
-    if (!fs::exists(logosPath)) {
-        fs::create_directory(logosPath);
+        auto symbol = std::find_if(snapshot.symbols.begin(), snapshot.symbols.end(),
+                                   [&alert](const SymbolSnapshot& s) { return s.apiName == alert.apiSymbol; });
+        if (symbol == snapshot.symbols.end()) continue;
+
+        // jump to the symbol on this frame's switch check, it stays until the flashing ends
+        currentSymbolIndex_ = static_cast<int>(symbol - snapshot.symbols.begin()) - 1;
+        nextSwitchTime = 0;
+        alertSymbol_ = alert.apiSymbol;
+        alertStart_ = std::chrono::steady_clock::now();
     }
+}
 
-    for (const auto& logo : config_->getLogoSubsList()) {
-        if (logo.empty()) continue;
+void Session::alertFlashCheck(const MarketSnapshot& snapshot) {
+    if (alertSymbol_.empty()) return;
 
-        std::string logoPath = LOGO_DIR + "/" + logo + LOGO_EXT;
-        fs::path symbolLogo{logoPath};
+    int index = currentSymbolIndex_;
+    if (index < 0 || index >= snapshot.symbols.size()) return;
+    const SymbolSnapshot& symbol = snapshot.symbols[index];
 
-        if (!fs::exists(symbolLogo) || cv::imread(logoPath).size().width != config_->getLogoSize()) {
-            try {
-                fetchLogo(logo).wait();
-            } catch (const std::exception& e) {
-                std::cerr << "Logo does not exist on the website. Try adding 'Logo_Subs_list' to the config file.\n";
-            }
+    auto elapsed = std::chrono::steady_clock::now() - alertStart_;
+    if (symbol.apiName != alertSymbol_ || elapsed >= std::chrono::seconds(ALERT_FLASH_TIME)) {
+        // the border is painted over the symbol, a full redraw removes it
+        alertSymbol_.clear();
+        renderer_.renderEntireSymbol(symbol);
+        renderedVersion_ = symbol.version;
+        return;
+    }
 
-            if (fs::exists(fs::path{LOGO_DIR + "/" + logo + LOGO_EXT})) {
-                ImageManipulator imgManipulator(LOGO_DIR + "/" + logo + LOGO_EXT);
-                imgManipulator.reduce(config_->getLogoSize(), config_->getLogoSize());
-            }
-        }
+    long long blinks = std::chrono::duration_cast<std::chrono::milliseconds>(elapsed).count() / ALERT_BLINK_TIME;
+    renderer_.renderAlertBorder(blinks % 2 == 0);
+    nextSwitchTime = std::max<long long>(nextSwitchTime, clock_->now() + 1);
+}
+
+// Widgets without a symbol of their own switch like the classic layout, grid pages turn with them.
+// Every symbol stays hot, a dashboard shows many of them at once.
+void Session::layoutCheck(const MarketSnapshot& snapshot) {
+    int symbolsCount = snapshot.symbols.size();
+    int index = currentSymbolIndex_;
+    if (clock_->now() > nextSwitchTime || index < 0 || index >= symbolsCount) {
+        index = (std::max(index, -1) + 1) % symbolsCount;
+        currentSymbolIndex_ = index;
+        layoutPage_ += 1;
+        nextSwitchTime = clock_->now() + config_->getSwitchTime();
     }
-}
\ No newline at end of file
+
+    renderer_.renderLayout(snapshot, index, layoutPage_);
+
+    if (alertSymbol_.empty()) return;
+
+    // the border blinks over the widgets, they are all redrawn once it is over
+    auto elapsed = std::chrono::steady_clock::now() - alertStart_;
+    if (elapsed >= std::chrono::seconds(ALERT_FLASH_TIME)) {
+        alertSymbol_.clear();
+        renderer_.invalidateLayout();
+        return;
+    }
+    long long blinks = std::chrono::duration_cast<std::chrono::milliseconds>(elapsed).count() / ALERT_BLINK_TIME;
+    renderer_.renderAlertBorder(blinks % 2 == 0);
+    nextSwitchTime = std::max<long long>(nextSwitchTime, clock_->now() + 1);
+}
+
+void Session::marqueeCheck(const MarketSnapshot& snapshot, std::chrono::steady_clock::duration elapsed) {
+    int symbolsCount = snapshot.symbols.size();
+    for (int i = 0; i < symbolsCount; i += 1) {
+        renderer_.updateMarqueeSegment(i, snapshot.symbols[i], symbolsCount);
+    }
+
+    int marqueeWidth = renderer_.getMarqueeWidth();
+    if (marqueeWidth == 0) return;
+
+    double seconds = std::chrono::duration<double>(elapsed).count();
+    int offset = static_cast<long long>(seconds * config_->getMarqueeSpeed()) % marqueeWidth;
+    renderer_.renderMarqueeFrame(offset);
+}
+
+void Session::saveLogos() {
+    logoFetcher_.fetchAll(executor_, config_->getLogoSubsList(), config_->getLogoSize());
+}
@@ -3,11 +3,35 @@
 
 #include <cpprest/ws_client.h>
 #include <set>
+#include <map>
 #include <memory>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
 #include "Core/Config.hpp"
-#include "Core/Images/ImageManipulator.hpp"
+#include "Core/Async/Coroutine.hpp"
+#include "Core/Async/Executor.hpp"
+#include "Core/Api/FeedBus.hpp"
+#include "Core/Api/FeedConnection.hpp"
+#include "Core/Api/FeedManager.hpp"
+#include "Core/Api/QueryService.hpp"
+#include "Core/Api/Providers/FinnhubProvider.hpp"
+#include "Core/Images/LogoFetcher.hpp"
 #include "Core/Database/DataStorage.hpp"
+#include "Core/Database/HistoryCompactor.hpp"
+#include "Core/Database/HistoryReader.hpp"
+#include "Core/Database/TickArchive.hpp"
 #include "Core/Render/Renderer.hpp"
+#include "Core/Render/SceneCache.hpp"
+#include "Core/Market/MarketState.hpp"
+#include "Core/Market/Timeframe.hpp"
+#include "Core/Market/Downsample.hpp"
+#include "Core/Market/AlertEngine.hpp"
+#include "Core/Market/WarmStart.hpp"
+#include "Core/Market/TradingCalendar.hpp"
+#include "Core/Market/SimulationScript.hpp"
+#include "Core/System/Clock.hpp"
 #include "Core/GlobalParams.hpp"
 
 using namespace web::websockets::client;
@@ -19,33 +43,114 @@ public:
     void chooseConfigAndSubscribe();
     void saveLogos();
     void runForever();
+    // Replays the script through the ingest and storage path on the simulated clock, as fast as it goes.
+    // Fails when a stored sample does not match the script or, in audited builds, a steady-state scope allocated.
+    bool runSimulation(const SimulationScript& script);
+    // Plays the stored history of [from, to] in seconds back on the panel, speed times faster than it happened.
+    void runPlayback(long long from, long long to, double speed, const std::string& timeframe);
 
 private:
-    pplx::task<void> fetchLogo(const std::string& logo);
-    void subscribeToSymbol(const std::string& symbol);
-    void processMessage(const std::string& update);
+    void setSymbols(const std::vector<std::string>& subs,
+                    const std::vector<std::string>& apiSubs,
+                    const std::vector<std::string>& logoSubs);
+    void processTicks(const std::vector<Tick>& ticks, const std::string& prefix);
+    void archiveTicks(const std::vector<Tick>& ticks, const std::string& prefix);
     void priceUpdateCheck();
-    void clearPriceHistory();
-    void render(std::string symbol, double price, bool savePrice, bool fully);
-    void primarySymbolSwitchCheck();
+    void marketHoursCheck();
+    void busBarCheck();
+    void historyLoadCheck();
+    void primarySymbolSwitchCheck(const MarketSnapshot& snapshot);
+    void marqueeCheck(const MarketSnapshot& snapshot, std::chrono::steady_clock::duration elapsed);
+    void layoutCheck(const MarketSnapshot& snapshot);
+    void alertCheck(const MarketSnapshot& snapshot, bool marquee);
+    void alertFlashCheck(const MarketSnapshot& snapshot);
     void configUpdate(const std::string& config);
-    void subscribe();
-    void disconnect();
-    void controllerSubscribe();
+    void subscribeFeeds(const std::vector<std::string>& apiSymbols);
+    void processBusMessage(const FeedBusMessage& message);
+    void feedCheck();
+    AsyncTask controllerSubscribe();
+    AsyncTask receiveControllerMessage(websocket_incoming_message msg);
+    AsyncTask closeController(std::shared_ptr<websocket_callback_client> client);
     void disconnectController();
+    void restoreWarmStart();
+    void warmStartSaveCheck();
+    bool simulationCheck(const SimulationScript& script);
+    bool playbackWait(std::chrono::steady_clock::time_point start, long long from, double speed, long long until);
 
-    std::unique_ptr<websocket_callback_client> client_;
-    std::unique_ptr<websocket_callback_client> controllerClient_;
+    // Rendering, persistence and networking each run on their own thread,
+    // so slow I/O never holds up a frame.
+    void renderLoop();
+    void sceneLoop();
+    void storageLoop();
+    void networkLoop();
+
+    // Ticks come from the providers, or from the feed daemon when Feed_Bus is set.
+    // Only the network thread touches either.
+    FeedManager feeds_;
+    std::unique_ptr<FeedBusClient> feedBus_;
+    long long nextStaleCheckTime_ = 0;
+
+    // every provider trade when Tick_Archive is set, written out by the storage thread
+    TickArchive archive_{TICK_ARCHIVE_DIR};
+
+    // bars stored by the feed daemon, appended to the charts by the storage thread
+    std::vector<std::pair<std::string, double>> pendingBars_;
+    std::mutex barsMutex_;
+    long long nextWarmStartSaveTime_ = 0;
+
+    // The network thread drives the executor, controller and logo coroutines resume there.
+    Executor executor_;
+
+    std::shared_ptr<websocket_callback_client> controllerClient_;
+    std::atomic<int> controllerGeneration_ = 0;  // close handlers of replaced clients are ignored
+    bool connectingToController_ = false;
+    ReconnectBackoff controllerBackoff_{std::chrono::milliseconds(RECONNECT_BASE_DELAY), std::chrono::milliseconds(RECONNECT_MAX_DELAY)};
 
     Config *config_ = Config::getInstance(CONFIG_FILE);
 
     DataStorage* dataStorage_ = DataStorage::getInstance();
+    TradingCalendar* calendar_ = TradingCalendar::getInstance();
+    Clock* clock_ = Clock::getInstance();
+
+    HistoryCompactor compactor_{{
+        {DB_TABLE, DB_ROLLUP_5M_TABLE, config_->getHistoryRetentionDays()},
+        {DB_ROLLUP_5M_TABLE, DB_ROLLUP_1H_TABLE, config_->getRollup5mRetentionDays()},
+        {DB_ROLLUP_1H_TABLE, DB_ROLLUP_1D_TABLE, config_->getRollup1hRetentionDays()},
+        {DB_ROLLUP_1D_TABLE, "", config_->getRollup1dRetentionDays()},
+    }, COMPACTION_CHECK_TIME};
 
     Renderer renderer_;
+    SceneCache sceneCache_{renderer_};
+
+    LogoFetcher logoFetcher_{config_->getLogoUrl()};
+
+    MarketState market_;
+    AlertEngine alerts_;
+
+    // serves prices and history to the controller and dashboards when Query_Listen is set
+    std::unique_ptr<QueryService> queryService_;
+
+    std::thread renderThread_;
+    std::thread sceneThread_;
+    std::thread storageThread_;
+    std::thread networkThread_;
+
+    std::string alertSymbol_;   // symbol being flashed by the render thread
+    std::chrono::steady_clock::time_point alertStart_;
 
-    std::unordered_map<std::string, double> latestPrices_;
+    std::atomic<long long> frameOverruns_ = 0;
+    long long renderedVersion_ = -1;
+    int layoutPage_ = 0;                    // grid page of the layout mode, turned every switch
+    bool primaryClosed_ = false;            // the render thread slows down while a closed market is on screen
+    std::atomic<int> openSymbols_ = -1;     // -1 until the storage thread first checked
+    std::map<MarketHours, int> symbolsByHours_;   // of the watchlist, symbols of the same hours open together
+    std::mutex symbolsByHoursMutex_;
+    std::vector<std::string> hotSymbols_;   // reused by every switch of the render thread
 
-    std::mutex priceConfigMutex;  // Mutex for price and config updates
+    long long switches_ = 0;
+    long long sceneMisses_ = 0;
+    std::chrono::steady_clock::duration switchLatency_ = std::chrono::steady_clock::duration::zero();
+    std::chrono::steady_clock::duration worstSwitchLatency_ = std::chrono::steady_clock::duration::zero();
 };
 
 #endif // SESSION_HPP
\ No newline at end of file
@@ -0,0 +1,59 @@
+#ifndef COROUTINE_HPP
+#define COROUTINE_HPP
+
+#include <coroutine>
+#include <exception>
+#include <iostream>
+#include <pplx/pplxtasks.h>
+#include "Core/Async/Executor.hpp"
+
+// Return type of fire-and-forget coroutines. The body runs right away up to
+// its first suspension, exceptions that escape it are logged.
+struct AsyncTask {
+    struct promise_type {
+        AsyncTask get_return_object() noexcept { return {}; }
+        std::suspend_never initial_suspend() noexcept { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }
+        void return_void() noexcept {}
+        void unhandled_exception() noexcept {
+            try {
+                throw;
+            } catch (const std::exception& e) {
+                std::cerr << "Exception occurred: " << e.what() << std::endl;
+            } catch (...) {
+                std::cerr << "Unknown exception occurred in a coroutine" << std::endl;
+            }
+        }
+    };
+};
+
+// Suspends a coroutine on a cpprest task without blocking any thread, it is
+// resumed on the executor once the task completes. Failures of the task are
+// rethrown from the co_await.
+template<typename T>
+class TaskAwaiter {
+public:
+    TaskAwaiter(Executor& executor, pplx::task<T> task) : executor_(executor), task_(std::move(task)) {}
+
+    bool await_ready() const { return task_.is_done(); }
+
+    void await_suspend(std::coroutine_handle<> handle) {
+        Executor* executor = &executor_;
+        task_.then([executor, handle](pplx::task<T>) {
+            executor->post(handle);
+        });
+    }
+
+    T await_resume() { return task_.get(); }
+
+private:
+    Executor& executor_;
+    pplx::task<T> task_;
+};
+
+template<typename T>
+TaskAwaiter<T> awaitTask(Executor& executor, pplx::task<T> task) {
+    return TaskAwaiter<T>(executor, std::move(task));
+}
+
+#endif // COROUTINE_HPP
@@ -0,0 +1,26 @@
+#include "Executor.hpp"
+
+void Executor::post(std::coroutine_handle<> handle) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        ready_.push_back(handle);
+    }
+    readyCondition_.notify_one();
+}
+
+void Executor::runFor(std::chrono::milliseconds duration) {
+    auto deadline = std::chrono::steady_clock::now() + duration;
+
+    while (true) {
+        std::coroutine_handle<> handle;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            if (!readyCondition_.wait_until(lock, deadline, [this] { return !ready_.empty(); })) {
+                return;
+            }
+            handle = ready_.front();
+            ready_.pop_front();
+        }
+        handle.resume();
+    }
+}
@@ -0,0 +1,37 @@
+#ifndef EXECUTOR_HPP
+#define EXECUTOR_HPP
+
+#include <chrono>
+#include <condition_variable>
+#include <coroutine>
+#include <deque>
+#include <mutex>
+
+// Runs coroutines on the thread that drives it. Completions of cpprest
+// tasks only post the waiting coroutine here, so coroutine bodies never run
+// on, or block, the cpprest thread pool.
+class Executor {
+public:
+    void post(std::coroutine_handle<> handle);
+
+    // Resumes posted coroutines until the duration has passed, sleeping while there are none.
+    void runFor(std::chrono::milliseconds duration);
+
+    // co_await executor.schedule() continues the coroutine on the executor thread.
+    auto schedule() {
+        struct Awaiter {
+            Executor& executor;
+            bool await_ready() const noexcept { return false; }
+            void await_suspend(std::coroutine_handle<> handle) { executor.post(handle); }
+            void await_resume() const noexcept {}
+        };
+        return Awaiter{*this};
+    }
+
+private:
+    std::deque<std::coroutine_handle<>> ready_;
+    std::mutex mutex_;
+    std::condition_variable readyCondition_;
+};
+
+#endif // EXECUTOR_HPP
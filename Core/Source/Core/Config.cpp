@@ -27,8 +27,29 @@ Config::Config(const std::string& fileName) {
         ("Api_Subs_list", po::value<std::string>(), "List of API names of symbols to be subscribed for")
         ("Logo_Subs_list", po::value<std::string>(), "Symbol to Icon name translation")
         ("Logo_Size", po::value<int>()->default_value(22), "Size of logo")
+        ("Logo_Url", po::value<std::string>()->default_value("https://financialmodelingprep.com/image-stock/"), "Where logos are downloaded from")
         ("Chart_Height", po::value<int>()->default_value(17), "Height of chart")
-        ("Switch_Time", po::value<int>()->default_value(5), "How often to switch between subscribed symbols");
+        ("Switch_Time", po::value<int>()->default_value(5), "How often to switch between subscribed symbols")
+        ("Display_Mode", po::value<std::string>()->default_value("switch"), "Either 'switch' between symbols, scroll them as a 'marquee' or draw the widgets of Layout with 'layout'")
+        ("Marquee_Speed", po::value<int>()->default_value(20), "Marquee scrolling speed in pixels per second")
+        ("Standby_Connection", po::value<bool>()->default_value(false), "Keep a second subscribed feed connection to fail over to")
+        ("Feed_Providers", po::value<std::string>()->default_value("finnhub"), "Market data providers, the first one serves symbols without a provider@ prefix")
+        ("Symbols_Per_Connection", po::value<int>()->default_value(50), "How many symbols share one feed connection")
+        ("Feed_Bus", po::value<std::string>()->default_value(""), "Unix socket of the feed daemon, when set ticks come from it instead of the providers")
+        ("Chart_Timeframe", po::value<std::string>()->default_value("1h"), "Time range covered by the chart: 1h, 1d, 1w, 1m or 1y")
+        ("Symbol_Timeframes", po::value<std::string>()->default_value(""), "Per symbol chart time ranges as <api symbol>=<timeframe>")
+        ("Chart_Indicators", po::value<std::string>()->default_value(""), "Indicators drawn over the chart: sma, ema and bollinger")
+        ("Thread_Placement", po::value<std::string>()->default_value(""), "CPUs and SCHED_FIFO priority per thread role as <role>=<cpu>[,<cpu>][:<priority>]")
+        ("Frame_Export", po::value<std::string>()->default_value(""), "POSIX shared memory name the displayed frames are published to, e.g. /tickerbox-frames")
+        ("Tick_Archive", po::value<bool>()->default_value(false), "Keep every trade in compressed per-symbol files under archive/")
+        ("Query_Listen", po::value<std::string>()->default_value(""), "Address of the HTTP query service for prices and history, e.g. http://0.0.0.0:8080")
+        ("Market_Hours", po::value<std::string>()->default_value(""), "Trading hours per api symbol or exchange as <symbol or exchange>=<24/7|forex|us>")
+        ("Market_Holidays", po::value<std::string>()->default_value(""), "US exchange holidays as YYYY-MM-DD, equities are treated as closed on them")
+        ("Layout", po::value<std::string>()->default_value(""), "Widgets of the layout display mode as <kind>[@<api symbol>]=<x>,<y>,<width>,<height>, see Render/Layout.hpp")
+        ("History_Retention_Days", po::value<int>()->default_value(7), "Days of per-minute prices kept before they are rolled into 5 minute bars")
+        ("Rollup_5m_Retention_Days", po::value<int>()->default_value(90), "Days of 5 minute bars kept before they are rolled into hourly ones")
+        ("Rollup_1h_Retention_Days", po::value<int>()->default_value(730), "Days of hourly bars kept before they are rolled into daily ones")
+        ("Rollup_1d_Retention_Days", po::value<int>()->default_value(0), "Days of daily bars kept, 0 keeps them forever");
 
     po::variables_map vm;
 
@@ -92,6 +113,13 @@ Config::Config(const std::string& fileName) {
         return;
     }
 
+    if (vm.count("Logo_Url")) {
+        logoUrl_ = vm["Logo_Url"].as<std::string>();
+    } else {
+        std::cerr << "Logo_Url is not defined in the configuration file" << std::endl;
+        return;
+    }
+
     if (vm.count("Chart_Height")) {
         chartHeight_ = vm["Chart_Height"].as<int>();
     } else {
@@ -105,6 +133,168 @@ Config::Config(const std::string& fileName) {
         std::cerr << "Switch_Time is not defined in the configuration file" << std::endl;
         return;
     }
+
+    if (vm.count("Display_Mode")) {
+        displayMode_ = vm["Display_Mode"].as<std::string>();
+    } else {
+        std::cerr << "Display_Mode is not defined in the configuration file" << std::endl;
+        return;
+    }
+
+    if (vm.count("Marquee_Speed")) {
+        marqueeSpeed_ = vm["Marquee_Speed"].as<int>();
+    } else {
+        std::cerr << "Marquee_Speed is not defined in the configuration file" << std::endl;
+        return;
+    }
+
+    if (vm.count("Standby_Connection")) {
+        standbyConnection_ = vm["Standby_Connection"].as<bool>();
+    } else {
+        std::cerr << "Standby_Connection is not defined in the configuration file" << std::endl;
+        return;
+    }
+
+    if (vm.count("Feed_Providers")) {
+        std::istringstream iss(vm["Feed_Providers"].as<std::string>());
+        std::string provider;
+        while (iss >> provider) {
+            feedProviders_.push_back(provider);
+        }
+    } else {
+        std::cerr << "Feed_Providers is not defined in the configuration file" << std::endl;
+    }
+
+    if (vm.count("Symbols_Per_Connection")) {
+        symbolsPerConnection_ = vm["Symbols_Per_Connection"].as<int>();
+    } else {
+        std::cerr << "Symbols_Per_Connection is not defined in the configuration file" << std::endl;
+        return;
+    }
+
+    if (vm.count("Feed_Bus")) {
+        feedBus_ = vm["Feed_Bus"].as<std::string>();
+    } else {
+        std::cerr << "Feed_Bus is not defined in the configuration file" << std::endl;
+    }
+
+    if (vm.count("Chart_Timeframe")) {
+        chartTimeframe_ = vm["Chart_Timeframe"].as<std::string>();
+    } else {
+        std::cerr << "Chart_Timeframe is not defined in the configuration file" << std::endl;
+        return;
+    }
+
+    if (vm.count("Symbol_Timeframes")) {
+        std::istringstream iss(vm["Symbol_Timeframes"].as<std::string>());
+        std::string entry;
+        while (iss >> entry) {
+            size_t separator = entry.rfind('=');
+            if (separator == std::string::npos) {
+                std::cerr << "Ignoring symbol timeframe without '=': " << entry << std::endl;
+                continue;
+            }
+            symbolTimeframes_[entry.substr(0, separator)] = entry.substr(separator + 1);
+        }
+    } else {
+        std::cerr << "Symbol_Timeframes is not defined in the configuration file" << std::endl;
+    }
+
+    if (vm.count("Chart_Indicators")) {
+        std::istringstream iss(vm["Chart_Indicators"].as<std::string>());
+        std::string indicator;
+        while (iss >> indicator) {
+            chartIndicators_.push_back(indicator);
+        }
+    } else {
+        std::cerr << "Chart_Indicators is not defined in the configuration file" << std::endl;
+    }
+
+    if (vm.count("Thread_Placement")) {
+        std::istringstream iss(vm["Thread_Placement"].as<std::string>());
+        std::string placement;
+        while (iss >> placement) {
+            threadPlacement_.push_back(placement);
+        }
+    } else {
+        std::cerr << "Thread_Placement is not defined in the configuration file" << std::endl;
+    }
+
+    if (vm.count("Frame_Export")) {
+        frameExport_ = vm["Frame_Export"].as<std::string>();
+    } else {
+        std::cerr << "Frame_Export is not defined in the configuration file" << std::endl;
+    }
+
+    if (vm.count("Tick_Archive")) {
+        tickArchive_ = vm["Tick_Archive"].as<bool>();
+    } else {
+        std::cerr << "Tick_Archive is not defined in the configuration file" << std::endl;
+    }
+
+    if (vm.count("Query_Listen")) {
+        queryListen_ = vm["Query_Listen"].as<std::string>();
+    } else {
+        std::cerr << "Query_Listen is not defined in the configuration file" << std::endl;
+    }
+
+    if (vm.count("Market_Hours")) {
+        std::istringstream iss(vm["Market_Hours"].as<std::string>());
+        std::string entry;
+        while (iss >> entry) {
+            marketHours_.push_back(entry);
+        }
+    } else {
+        std::cerr << "Market_Hours is not defined in the configuration file" << std::endl;
+    }
+
+    if (vm.count("Market_Holidays")) {
+        std::istringstream iss(vm["Market_Holidays"].as<std::string>());
+        std::string holiday;
+        while (iss >> holiday) {
+            marketHolidays_.push_back(holiday);
+        }
+    } else {
+        std::cerr << "Market_Holidays is not defined in the configuration file" << std::endl;
+    }
+
+    if (vm.count("Layout")) {
+        std::istringstream iss(vm["Layout"].as<std::string>());
+        std::string widget;
+        while (iss >> widget) {
+            layout_.push_back(widget);
+        }
+    } else {
+        std::cerr << "Layout is not defined in the configuration file" << std::endl;
+    }
+
+    if (vm.count("History_Retention_Days")) {
+        historyRetentionDays_ = vm["History_Retention_Days"].as<int>();
+    } else {
+        std::cerr << "History_Retention_Days is not defined in the configuration file" << std::endl;
+        return;
+    }
+
+    if (vm.count("Rollup_5m_Retention_Days")) {
+        rollup5mRetentionDays_ = vm["Rollup_5m_Retention_Days"].as<int>();
+    } else {
+        std::cerr << "Rollup_5m_Retention_Days is not defined in the configuration file" << std::endl;
+        return;
+    }
+
+    if (vm.count("Rollup_1h_Retention_Days")) {
+        rollup1hRetentionDays_ = vm["Rollup_1h_Retention_Days"].as<int>();
+    } else {
+        std::cerr << "Rollup_1h_Retention_Days is not defined in the configuration file" << std::endl;
+        return;
+    }
+
+    if (vm.count("Rollup_1d_Retention_Days")) {
+        rollup1dRetentionDays_ = vm["Rollup_1d_Retention_Days"].as<int>();
+    } else {
+        std::cerr << "Rollup_1d_Retention_Days is not defined in the configuration file" << std::endl;
+        return;
+    }
 }
 
 std::string Config::getToken() const {
@@ -143,6 +333,10 @@ int Config::getLogoSize() const {
     return logoSize_;
 }
 
+std::string Config::getLogoUrl() const {
+    return logoUrl_;
+}
+
 int Config::getChartHeight() const {
     return chartHeight_;
 }
@@ -154,3 +348,80 @@ int Config::getSwitchTime() const {
 void Config::setSwitchTime(int switchTime) {
     switchTime_ = switchTime;
 }
+
+std::string Config::getDisplayMode() const {
+    return displayMode_;
+}
+
+int Config::getMarqueeSpeed() const {
+    return marqueeSpeed_;
+}
+
+bool Config::getStandbyConnection() const {
+    return standbyConnection_;
+}
+
+std::vector<std::string> Config::getFeedProviders() const {
+    return feedProviders_;
+}
+
+int Config::getSymbolsPerConnection() const {
+    return symbolsPerConnection_;
+}
+
+std::string Config::getFeedBus() const {
+    return feedBus_;
+}
+
+std::string Config::getChartTimeframe(const std::string& apiSymbol) const {
+    auto it = symbolTimeframes_.find(apiSymbol);
+    return it != symbolTimeframes_.end() ? it->second : chartTimeframe_;
+}
+
+std::vector<std::string> Config::getChartIndicators() const {
+    return chartIndicators_;
+}
+
+std::vector<std::string> Config::getThreadPlacement() const {
+    return threadPlacement_;
+}
+
+std::string Config::getFrameExport() const {
+    return frameExport_;
+}
+
+bool Config::getTickArchive() const {
+    return tickArchive_;
+}
+
+std::string Config::getQueryListen() const {
+    return queryListen_;
+}
+
+std::vector<std::string> Config::getMarketHours() const {
+    return marketHours_;
+}
+
+std::vector<std::string> Config::getMarketHolidays() const {
+    return marketHolidays_;
+}
+
+std::vector<std::string> Config::getLayout() const {
+    return layout_;
+}
+
+int Config::getHistoryRetentionDays() const {
+    return historyRetentionDays_;
+}
+
+int Config::getRollup5mRetentionDays() const {
+    return rollup5mRetentionDays_;
+}
+
+int Config::getRollup1hRetentionDays() const {
+    return rollup1hRetentionDays_;
+}
+
+int Config::getRollup1dRetentionDays() const {
+    return rollup1dRetentionDays_;
+}
@@ -3,6 +3,8 @@
 
 #include <string>
 #include <vector>
+#include <atomic>
+#include <unordered_map>
 
 class Config {
 
@@ -16,8 +18,28 @@ public:
     std::vector<std::string> getApiSubsList() const;
     std::vector<std::string> getLogoSubsList() const;
     int getLogoSize() const;
+    std::string getLogoUrl() const;
     int getChartHeight() const;
     int getSwitchTime() const;
+    std::string getDisplayMode() const;
+    int getMarqueeSpeed() const;
+    bool getStandbyConnection() const;
+    std::vector<std::string> getFeedProviders() const;
+    int getSymbolsPerConnection() const;
+    std::string getFeedBus() const;
+    std::string getChartTimeframe(const std::string& apiSymbol) const;
+    std::vector<std::string> getChartIndicators() const;
+    std::vector<std::string> getThreadPlacement() const;
+    std::string getFrameExport() const;
+    bool getTickArchive() const;
+    std::string getQueryListen() const;
+    std::vector<std::string> getMarketHours() const;
+    std::vector<std::string> getMarketHolidays() const;
+    std::vector<std::string> getLayout() const;
+    int getHistoryRetentionDays() const;
+    int getRollup5mRetentionDays() const;
+    int getRollup1hRetentionDays() const;
+    int getRollup1dRetentionDays() const;
 
     // Setter methods
     void setSubsList(const std::vector<std::string>& subsList);
@@ -39,8 +61,29 @@ private:
     std::vector<std::string> apiSubsList_;
     std::vector<std::string> logoSubsList_;
     int logoSize_;
+    std::string logoUrl_ = "https://financialmodelingprep.com/image-stock/";
     int chartHeight_;
-    int switchTime_;
+    std::atomic<int> switchTime_; // updated by the controller while frames are rendered
+    std::string displayMode_ = "switch";
+    int marqueeSpeed_ = 20;
+    bool standbyConnection_ = false;
+    std::vector<std::string> feedProviders_;
+    int symbolsPerConnection_ = 50;
+    std::string feedBus_;
+    std::string chartTimeframe_ = "1h";
+    std::unordered_map<std::string, std::string> symbolTimeframes_; // api symbol -> timeframe
+    std::vector<std::string> chartIndicators_;
+    std::vector<std::string> threadPlacement_;
+    std::string frameExport_;
+    bool tickArchive_ = false;
+    std::string queryListen_;
+    std::vector<std::string> marketHours_;
+    std::vector<std::string> marketHolidays_;
+    std::vector<std::string> layout_;
+    int historyRetentionDays_ = 7;
+    int rollup5mRetentionDays_ = 90;
+    int rollup1hRetentionDays_ = 730;
+    int rollup1dRetentionDays_ = 0;
 
     bool boolRenderLogos_;
 };
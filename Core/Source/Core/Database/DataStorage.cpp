@@ -1,3 +1,5 @@
+#include <algorithm>
+#include <ctime>
 #include <iostream>
 #include <thread>
 #include <chrono>
@@ -8,6 +10,18 @@
 DataStorage* DataStorage::instance_ = nullptr;
 std::mutex dbMutex;
 
+namespace {
+    const std::vector<std::string> ROLLUP_TABLES = {DB_ROLLUP_5M_TABLE, DB_ROLLUP_1H_TABLE, DB_ROLLUP_1D_TABLE};
+
+    // Start of the rollup bucket a timestamp expression falls into
+    std::string bucketOf(const std::string& table, const std::string& time) {
+        if (table == DB_ROLLUP_5M_TABLE) {
+            return "DATE_TRUNC('hour', " + time + ") + FLOOR(EXTRACT(MINUTE FROM " + time + ") / 5) * INTERVAL '5 minutes'";
+        }
+        return "DATE_TRUNC('" + std::string(table == DB_ROLLUP_1H_TABLE ? "hour" : "day") + "', " + time + ")";
+    }
+}
+
 // singleton
 DataStorage* DataStorage::getInstance() {
    if (instance_ == nullptr) {
@@ -18,16 +32,21 @@ DataStorage* DataStorage::getInstance() {
 
 DataStorage::DataStorage(){
     // connect to PostgreSQL
-    connect();
+    verifyConnection();
 }
 
 DataStorage::~DataStorage(){
-    connection_->disconnect();
+    if (connection_) {
+        connection_->disconnect();
+    }
 }
 
 void DataStorage::connect() {
+    spoolStateLoaded_ = false;
     try {
-        connection_ = std::make_unique<pqxx::connection>("dbname=" + DB_NAME + " user=" + DB_USER + 
+        // a simulated day never lands in the live history
+        std::string name = clock_->isSimulated() ? DB_SIMULATION_NAME : DB_NAME;
+        connection_ = std::make_unique<pqxx::connection>("dbname=" + name + " user=" + DB_USER + 
             " password=" + DB_PASS + 
             " hostaddr=127.0.0.1 port=5432");
         if (connection_->is_open()) {
@@ -40,38 +59,137 @@ void DataStorage::connect() {
     }
 }
 
-void DataStorage::verifyConnection() {
-    while (!connection_->is_open()) {
-        try {
-            connect();
-            std::this_thread::sleep_for(std::chrono::seconds(3));
-        } catch (const std::exception &e) {
-            std::cerr << e.what() << std::endl;
+void DataStorage::createTables() {
+    try {
+        std::lock_guard<std::mutex> lock(dbMutex);
+        pqxx::work W(*connection_);
+        W.exec("CREATE TABLE IF NOT EXISTS " + DB_TABLE + " ( \
+                    symbol VARCHAR(100), \
+                    price FLOAT, \
+                    time TIMESTAMP DEFAULT NOW() \
+                );");
+        // retention deletes walk the history by age
+        W.exec("CREATE INDEX IF NOT EXISTS " + DB_TABLE + "_time_idx ON " + DB_TABLE + " (time);");
+        for (const auto& table : ROLLUP_TABLES) {
+            W.exec("CREATE TABLE IF NOT EXISTS " + table + " ( \
+                        symbol VARCHAR(100), \
+                        bucket TIMESTAMP, \
+                        open FLOAT, \
+                        high FLOAT, \
+                        low FLOAT, \
+                        close FLOAT, \
+                        PRIMARY KEY (symbol, bucket) \
+                    );");
         }
+        W.exec("CREATE TABLE IF NOT EXISTS " + DB_SPOOL_TABLE + " ( \
+                    id INT PRIMARY KEY, \
+                    sequence BIGINT \
+                );");
+        W.commit();
+    } catch (const std::exception &e) {
+        std::cerr << e.what() << std::endl;
     }
 }
 
+bool DataStorage::verifyConnection() {
+    std::lock_guard<std::mutex> lock(connectMutex_);
+    if (connection_ && connection_->is_open()) return true;
+
+    // the callers carry on without the database, the prices wait in the spool
+    long long now = time(nullptr);
+    if (now < nextConnectTime_) return false;
+    nextConnectTime_ = now + DB_RECONNECT_TIME;
+
+    connect();
+    if (!connection_ || !connection_->is_open()) return false;
+    createTables();
+    return true;
+}
+
 void DataStorage::savePrice(const std::string symbol, double price) {
-    verifyConnection();
-    // save to database
-    try {
-        std::string sql = "INSERT INTO " + DB_TABLE + " VALUES ('" + symbol + "', " + std::to_string(price) + ");";
+    savePrices({{symbol, price}});
+}
 
-        /* Create a transactional object. */
+void DataStorage::savePrices(const std::vector<std::pair<std::string, double>>& prices) {
+    if (prices.empty()) return;
+
+    spool_.append(prices, clock_->nowMilliseconds());
+    replay();
+}
+
+void DataStorage::replayCheck() {
+    size_t backlog = spool_.backlog();
+    if (backlog == 0) return;
+
+    if (replay() && backlog > SPOOL_REPLAY_BATCH) {
+        std::cout << "Replayed spooled prices, " << spool_.backlog() << " left" << std::endl;
+    }
+}
+
+// The oldest spooled batch goes in with the sequence it reaches in one
+// transaction, a replay after an unconfirmed commit skips what landed.
+bool DataStorage::replay() {
+    if (!verifyConnection()) return false;
+
+    try {
         std::lock_guard<std::mutex> lock(dbMutex);
+        if (!spoolStateLoaded_) {
+            pqxx::nontransaction n(*connection_);
+            pqxx::result res = n.exec("SELECT sequence FROM " + DB_SPOOL_TABLE + " WHERE id = 1;");
+            uint64_t sequence = 0;
+            for (auto row : res) {
+                sequence = std::stoull(row[0].c_str());
+            }
+            // nothing is written before the spool's numbering is above the stored one
+            if (!spool_.resume(sequence)) return false;
+            spoolStateLoaded_ = true;
+        }
+
+        std::vector<SpooledPrice> records = spool_.pending(SPOOL_REPLAY_BATCH);
+        if (records.empty()) return true;
+
         pqxx::work W(*connection_);
-        
-        /* Execute SQL query */
-        W.exec(sql);
+        writeSamples(W, records);
+        W.exec("INSERT INTO " + DB_SPOOL_TABLE + " VALUES (1, " + std::to_string(records.back().sequence) + ") \
+                ON CONFLICT (id) DO UPDATE SET sequence = EXCLUDED.sequence;");
         W.commit();
+        spool_.acknowledge(records.back().sequence);
     } catch (const std::exception &e) {
         std::cerr << e.what() << std::endl;
+        spoolStateLoaded_ = false;
+        return false;
     }
+    return true;
 }
 
-std::deque<double> DataStorage::getPriceHistory(const std::string symbol, int period) {
-    verifyConnection();
+// One statement per table for any number of samples, a replayed backlog
+// folds its samples per rollup bucket before they meet the stored bars.
+void DataStorage::writeSamples(pqxx::work& W, const std::vector<SpooledPrice>& records) {
+    std::string samples;
+    for (const auto& record : records) {
+        samples += std::string(samples.empty() ? "" : ", ") + "('" + record.apiSymbol + "', " + std::to_string(record.price) +
+                   "::FLOAT, TO_TIMESTAMP(" + std::to_string(record.time / 1000.0) + "))";
+    }
+
+    /* Execute SQL query */
+    W.exec("INSERT INTO " + DB_TABLE + " (symbol, price, time) VALUES " + samples + ";");
+
+    // the rollups are folded in with the samples, long charts never scan the raw history
+    for (const auto& table : ROLLUP_TABLES) {
+        W.exec("INSERT INTO " + table + " AS r \
+                SELECT symbol, " + bucketOf(table, "time") + " AS bucket, \
+                       (ARRAY_AGG(price ORDER BY time))[1], MAX(price), MIN(price), (ARRAY_AGG(price ORDER BY time DESC))[1] \
+                FROM (VALUES " + samples + ") AS v(symbol, price, time) GROUP BY symbol, bucket \
+                ON CONFLICT (symbol, bucket) DO UPDATE SET \
+                high = GREATEST(r.high, EXCLUDED.high), \
+                low = LEAST(r.low, EXCLUDED.low), \
+                close = EXCLUDED.close;");
+    }
+}
+
+std::optional<std::deque<double>> DataStorage::getPriceHistory(const std::string symbol, int period) {
     std::deque<double> prices;
+    if (!verifyConnection()) return std::nullopt;
     prices.clear();
     
     // get price history from the database
@@ -79,8 +197,8 @@ std::deque<double> DataStorage::getPriceHistory(const std::string symbol, int pe
         std::string sql = R"(
         WITH filled_times AS (
             SELECT generate_series(
-                now() - interval ')" + std::to_string(period) + R"( minutes',  -- start time
-                now(),                          -- end time (current time)
+                )" + sqlNow() + R"( - interval ')" + std::to_string(period) + R"( minutes',  -- start time
+                )" + sqlNow() + R"(,                          -- end time (current time)
                 interval ')" + std::to_string(PRICE_TIME_INTERVAL) + R"( seconds'           -- interval between each timestamp
             ) AS time
         ),
@@ -110,15 +228,90 @@ std::deque<double> DataStorage::getPriceHistory(const std::string symbol, int pe
         }
     } catch (const std::exception &e) {
         std::cerr << e.what() << std::endl;
+        return std::nullopt;
     }
     return prices;
 }
 
+std::optional<std::vector<std::pair<double, double>>> DataStorage::getRollupHistory(const std::string symbol, const std::string& table, int span) {
+    std::vector<std::pair<double, double>> points;
+    if (!verifyConnection()) return std::nullopt;
+    try {
+        std::string sql = "SELECT EXTRACT(EPOCH FROM bucket), close FROM " + table + " \
+                           WHERE symbol = '" + symbol + "' \
+                           AND bucket >= " + sqlNow() + " - INTERVAL '" + std::to_string(span) + " seconds' \
+                           ORDER BY bucket;";
+
+        // Create a non-transactional object
+        std::lock_guard<std::mutex> lock(dbMutex);
+        pqxx::nontransaction n(*connection_);
+
+        // Execute SQL query
+        pqxx::result res = n.exec(sql);
+
+        // Process results
+        for (auto row : res) {
+            points.emplace_back(std::stod(row[0].c_str()), std::stod(row[1].c_str()));
+        }
+    } catch (const std::exception &e) {
+        std::cerr << e.what() << std::endl;
+        return std::nullopt;
+    }
+    return points;
+}
+
+int DataStorage::compactBatch(const std::string& table, const std::string& target, int retentionDays, int batchSize) {
+    int rows = 0;
+    if (!verifyConnection()) return rows;
+    try {
+        bool raw = table == DB_TABLE;
+        std::string timeColumn = raw ? "time" : "bucket";
+        std::string sql = "WITH doomed AS ( \
+                               DELETE FROM " + table + " WHERE ctid IN ( \
+                                   SELECT ctid FROM " + table + " \
+                                   WHERE " + timeColumn + " < " + sqlNow() + " - INTERVAL '" + std::to_string(retentionDays) + " days' \
+                                   LIMIT " + std::to_string(batchSize) + ") \
+                               RETURNING symbol, " + timeColumn + " AS time, " +
+                               (raw ? "price AS open, price AS high, price AS low, price AS close" : "open, high, low, close") + ")";
+        if (!target.empty()) {
+            // buckets written live are complete already, only older ones are filled in
+            sql += ", rolled AS ( \
+                        INSERT INTO " + target + " \
+                        SELECT symbol, " + bucketOf(target, "time") + " AS bucket, \
+                               (ARRAY_AGG(open ORDER BY time))[1], MAX(high), MIN(low), (ARRAY_AGG(close ORDER BY time DESC))[1] \
+                        FROM doomed GROUP BY symbol, bucket \
+                        ON CONFLICT DO NOTHING)";
+        }
+        sql += " SELECT COUNT(*) FROM doomed;";
+
+        /* Create a transactional object. */
+        std::lock_guard<std::mutex> lock(dbMutex);
+        pqxx::work W(*connection_);
+
+        /* Execute SQL query */
+        pqxx::result res = W.exec(sql);
+        W.commit();
+
+        // Process results
+        for (auto row : res) {
+            rows = std::stoi(row[0].c_str());
+        }
+    } catch (const std::exception &e) {
+        std::cerr << e.what() << std::endl;
+    }
+    return rows;
+}
+
 int DataStorage::secondsSinceLastUpdate() {
-    verifyConnection();
+    // samples waiting in the spool count, the sampling keeps its pace through an outage
     int seconds = std::numeric_limits<int>::max();
+    long long spooled = spool_.lastTime();
+    if (spooled != 0) {
+        seconds = (clock_->nowMilliseconds() - spooled) / 1000;
+    }
+    if (!verifyConnection()) return seconds;
     try {
-        std::string sql = "SELECT EXTRACT(EPOCH FROM (NOW() - MAX(time))) \
+        std::string sql = "SELECT EXTRACT(EPOCH FROM (" + sqlNow() + " - MAX(time))) \
                            FROM " + DB_TABLE + ";";
         
         // Create a non-transactional object
@@ -130,7 +323,7 @@ int DataStorage::secondsSinceLastUpdate() {
         
         // Process results
         for (auto row : res) {
-            seconds = std::stoi(row[0].c_str());
+            seconds = std::min(seconds, std::stoi(row[0].c_str()));
         }   
     } catch (const std::exception &e) {
         std::cerr << e.what() << std::endl;
@@ -138,9 +331,9 @@ int DataStorage::secondsSinceLastUpdate() {
     return seconds;
 }
 
-double DataStorage::getLastPrice(const std::string symbol) {
-    verifyConnection();
+std::optional<double> DataStorage::getLastPrice(const std::string symbol) {
     double price = ZERO_PRICE;
+    if (!verifyConnection()) return std::nullopt;
     try {
         std::string sql = "SELECT price FROM " + DB_TABLE + " WHERE symbol = '" + symbol + "'\
                         ORDER BY time \
@@ -159,17 +352,18 @@ double DataStorage::getLastPrice(const std::string symbol) {
         }
     } catch (const std::exception &e) {
         std::cerr << e.what() << std::endl;
+        return std::nullopt;
     }
     return price;
 } 
 
-double DataStorage::closedMarketPrice(const std::string symbol) {
-    verifyConnection();
+std::optional<double> DataStorage::closedMarketPrice(const std::string symbol) {
     double price = ZERO_PRICE;
+    if (!verifyConnection()) return std::nullopt;
     try {
         // SQL to select price closest to 00:00.
         std::string sql = "WITH today_midnight AS ( \
-                          SELECT DATE_TRUNC('day', NOW()) AS midnight \
+                          SELECT DATE_TRUNC('day', " + sqlNow() + ") AS midnight \
                           ) \
                           SELECT price \
                           FROM " + DB_TABLE + ", today_midnight \
@@ -190,6 +384,58 @@ double DataStorage::closedMarketPrice(const std::string symbol) {
         }
     } catch (const std::exception &e) {
         std::cerr << e.what() << std::endl;
+        return std::nullopt;
     }
     return price;
 }
+
+std::vector<std::pair<long long, double>> DataStorage::getSamples(const std::string symbol, long long from, long long to) {
+    std::vector<std::pair<long long, double>> samples;
+    if (!verifyConnection()) return samples;
+    try {
+        std::string sql = "SELECT EXTRACT(EPOCH FROM time::TIMESTAMPTZ), price FROM " + DB_TABLE + " \
+                           WHERE symbol = '" + symbol + "' \
+                           AND time BETWEEN TO_TIMESTAMP(" + std::to_string(from) + ") AND TO_TIMESTAMP(" + std::to_string(to) + ") \
+                           ORDER BY time;";
+
+        // Create a non-transactional object
+        std::lock_guard<std::mutex> lock(dbMutex);
+        pqxx::nontransaction n(*connection_);
+
+        // Execute SQL query
+        pqxx::result res = n.exec(sql);
+
+        // Process results
+        for (auto row : res) {
+            samples.emplace_back(static_cast<long long>(std::stod(row[0].c_str())), std::stod(row[1].c_str()));
+        }
+    } catch (const std::exception &e) {
+        std::cerr << e.what() << std::endl;
+    }
+    return samples;
+}
+
+void DataStorage::clearSimulation() {
+    if (!clock_->isSimulated()) return;
+
+    spool_.clear();
+    if (!verifyConnection()) return;
+    try {
+        std::lock_guard<std::mutex> lock(dbMutex);
+        pqxx::work W(*connection_);
+        W.exec("TRUNCATE " + DB_TABLE + ", " + DB_SPOOL_TABLE + ";");
+        for (const auto& table : ROLLUP_TABLES) {
+            W.exec("TRUNCATE " + table + ";");
+        }
+        W.commit();
+    } catch (const std::exception &e) {
+        std::cerr << e.what() << std::endl;
+    }
+}
+
+// The database's own NOW() on the live clock, so real runs keep their exact timestamps.
+std::string DataStorage::sqlNow() const {
+    if (!clock_->isSimulated()) return "NOW()";
+
+    return "TO_TIMESTAMP(" + std::to_string(clock_->nowMilliseconds() / 1000.0) + ")";
+}
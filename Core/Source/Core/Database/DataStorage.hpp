@@ -4,11 +4,28 @@
 #include <pqxx/pqxx>
 #include <limits>
 #include <deque>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+#include <mutex>
+#include <optional>
+#include "Core/Database/PriceSpool.hpp"
+#include "Core/System/Clock.hpp"
+#include "Core/GlobalParams.hpp"
+
+#define DB_RECONNECT_TIME 10 // in seconds
+#define SPOOL_REPLAY_BATCH 5000 // spooled prices per replay transaction
 
 const std::string DB_NAME = "ticker";
+const std::string DB_SIMULATION_NAME = "ticker_simulation";   // used while the clock is simulated
 const std::string DB_USER = "postgres";
 const std::string DB_PASS = "postgres";
 const std::string DB_TABLE = "ticker_history";
+const std::string DB_ROLLUP_5M_TABLE = "ticker_rollup_5m";
+const std::string DB_ROLLUP_1H_TABLE = "ticker_rollup_1h";
+const std::string DB_ROLLUP_1D_TABLE = "ticker_rollup_1d";
+const std::string DB_SPOOL_TABLE = "ticker_spool_state";   // last spool sequence in the history
 
 class DataStorage {
 
@@ -17,11 +34,25 @@ public:
 
     void connect();
     void savePrice(const std::string symbol, double price);
-    std::deque<double> getPriceHistory(const std::string symbol, int period);
+    // Spooled to disk first, then written with the backlog in front of it, if the database is reachable.
+    void savePrices(const std::vector<std::pair<std::string, double>>& prices);
+    // Storage thread: catches the database up on the spool, one batch per call.
+    void replayCheck();
+    // Readers return nothing while the database is unreachable, the callers keep what they have.
+    std::optional<std::deque<double>> getPriceHistory(const std::string symbol, int period);
+    std::optional<std::vector<std::pair<double, double>>> getRollupHistory(const std::string symbol, const std::string& table, int span);
+    // Deletes up to batchSize rows past retention, folding them into the coarser target table.
+    // Returns the number of rows deleted.
+    int compactBatch(const std::string& table, const std::string& target, int retentionDays, int batchSize);
     int secondsSinceLastUpdate();
-    double closedMarketPrice(const std::string symbol);
-    double getLastPrice(const std::string symbol);
-    void verifyConnection();
+    std::optional<double> closedMarketPrice(const std::string symbol);
+    std::optional<double> getLastPrice(const std::string symbol);
+    // Stored samples of [from, to] in seconds, as (time, price).
+    std::vector<std::pair<long long, double>> getSamples(const std::string symbol, long long from, long long to);
+    // Empties the history and rollups of the simulation database before a run, never the live one.
+    void clearSimulation();
+    // Never waits for the database, a lost connection is retried every DB_RECONNECT_TIME.
+    bool verifyConnection();
 
 private:
     static DataStorage* instance_;   // The one, single instance
@@ -30,7 +61,18 @@ private:
     DataStorage(const DataStorage&);
     DataStorage& operator=(const DataStorage&);
 
+    void createTables();
+    bool replay();
+    void writeSamples(pqxx::work& W, const std::vector<SpooledPrice>& records);
+    std::string sqlNow() const;
+
     std::unique_ptr<pqxx::connection> connection_;
+    Clock* clock_ = Clock::getInstance();
+
+    PriceSpool spool_{clock_->isSimulated() ? SIMULATION_SPOOL_FILE : PRICE_SPOOL_FILE};
+    bool spoolStateLoaded_ = false;   // per connection, the sequence may have moved with an unconfirmed commit
+    long long nextConnectTime_ = 0;
+    std::mutex connectMutex_;
 };
 
 #endif // DATA_STORAGE_HPP
@@ -0,0 +1,54 @@
+#include <ctime>
+#include <iostream>
+#include "HistoryCompactor.hpp"
+
+HistoryCompactor::HistoryCompactor(std::vector<Stage> stages, int interval)
+    : stages_(std::move(stages)), interval_(interval) {}
+
+void HistoryCompactor::step() {
+    if (!running_) {
+        if (time(nullptr) < nextRunTime_) return;
+        running_ = true;
+        stage_ = 0;
+        compacted_.assign(stages_.size(), 0);
+        runStart_ = std::chrono::steady_clock::now();
+        busy_ = std::chrono::steady_clock::duration::zero();
+    }
+
+    while (stage_ < stages_.size() && stages_[stage_].retentionDays <= 0) {
+        stage_ += 1;
+    }
+    if (stage_ == stages_.size()) {
+        finishRun();
+        return;
+    }
+
+    const Stage& stage = stages_[stage_];
+    auto batchStart = std::chrono::steady_clock::now();
+    int rows = dataStorage_->compactBatch(stage.table, stage.target, stage.retentionDays, COMPACTION_BATCH_SIZE);
+    busy_ += std::chrono::steady_clock::now() - batchStart;
+
+    compacted_[stage_] += rows;
+    if (rows < COMPACTION_BATCH_SIZE) {
+        stage_ += 1;
+    }
+}
+
+void HistoryCompactor::finishRun() {
+    running_ = false;
+    nextRunTime_ = time(nullptr) + interval_;
+
+    long long total = 0;
+    for (long long rows : compacted_) total += rows;
+    if (total == 0) return;
+
+    std::cout << "History compaction:";
+    for (size_t i = 0; i < stages_.size(); i += 1) {
+        if (compacted_[i] > 0) {
+            std::cout << " " << stages_[i].table << " " << compacted_[i] << " rows";
+        }
+    }
+    std::cout << ", " << std::chrono::duration_cast<std::chrono::milliseconds>(busy_).count() << "ms in queries, "
+              << std::chrono::duration_cast<std::chrono::seconds>(std::chrono::steady_clock::now() - runStart_).count()
+              << "s overall" << std::endl;
+}
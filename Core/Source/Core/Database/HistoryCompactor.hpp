@@ -0,0 +1,42 @@
+#ifndef HISTORY_COMPACTOR_HPP
+#define HISTORY_COMPACTOR_HPP
+
+#include <chrono>
+#include <string>
+#include <vector>
+#include "Core/Database/DataStorage.hpp"
+
+#define COMPACTION_BATCH_SIZE 2000
+
+// Prunes history past its retention in small batches, raw minutes into
+// 5 minute bars, those into hourly and hourly into daily ones. One batch
+// is done per step() so the storage thread keeps saving prices in between.
+class HistoryCompactor {
+public:
+    struct Stage {
+        std::string table;
+        std::string target;   // empty when expired rows are only deleted
+        int retentionDays;    // 0 keeps the table forever
+    };
+
+    HistoryCompactor(std::vector<Stage> stages, int interval);
+
+    void step();
+
+private:
+    void finishRun();
+
+    DataStorage* dataStorage_ = DataStorage::getInstance();
+
+    std::vector<Stage> stages_;
+    int interval_;          // in seconds
+
+    long long nextRunTime_ = 0;
+    bool running_ = false;
+    size_t stage_ = 0;
+    std::vector<long long> compacted_;
+    std::chrono::steady_clock::time_point runStart_;
+    std::chrono::steady_clock::duration busy_ = std::chrono::steady_clock::duration::zero();
+};
+
+#endif // HISTORY_COMPACTOR_HPP
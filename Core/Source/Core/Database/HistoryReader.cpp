@@ -0,0 +1,127 @@
+#include <cmath>
+#include <iostream>
+#include "HistoryReader.hpp"
+#include "Core/GlobalParams.hpp"
+
+namespace {
+    const std::vector<std::string> ROLLUP_TABLES = {DB_ROLLUP_5M_TABLE, DB_ROLLUP_1H_TABLE, DB_ROLLUP_1D_TABLE};
+}
+
+// Connects and prepares the statements on first use, and again after the connection dropped.
+bool HistoryReader::connect() {
+    if (connection_ && connection_->is_open()) return true;
+
+    try {
+        connection_ = std::make_unique<pqxx::connection>("dbname=" + DB_NAME + " user=" + DB_USER +
+            " password=" + DB_PASS +
+            " hostaddr=127.0.0.1 port=5432");
+
+        // same window as DataStorage::getPriceHistory, $1 symbol, $2 minutes
+        connection_->prepare("price_history", R"(
+        WITH filled_times AS (
+            SELECT generate_series(
+                now() - $2 * interval '1 minute',
+                now(),
+                interval ')" + std::to_string(PRICE_TIME_INTERVAL) + R"( seconds'
+            ) AS time
+        ),
+        filled_data AS (
+            SELECT ft.time,
+                COALESCE(th.price, )" + std::to_string(MISSING_PRICE) + R"() AS price
+            FROM filled_times ft
+            LEFT JOIN )" + DB_TABLE + R"( th ON th.time >= ft.time
+                                        AND th.time < ft.time + interval ')" + std::to_string(PRICE_TIME_INTERVAL) + R"( seconds'
+                        AND th.symbol = $1
+        )
+        SELECT price
+        FROM filled_data
+        ORDER BY time
+        LIMIT $2;)");
+
+        // one statement per table, $1 symbol, $2 span in seconds
+        for (const auto& table : ROLLUP_TABLES) {
+            connection_->prepare(table, "SELECT EXTRACT(EPOCH FROM bucket), close FROM " + table + " \
+                                         WHERE symbol = $1 \
+                                         AND bucket >= NOW() - $2 * INTERVAL '1 second' \
+                                         ORDER BY bucket;");
+        }
+        return true;
+    } catch (const std::exception &e) {
+        std::cerr << "History reader: " << e.what() << std::endl;
+        connection_.reset();
+        return false;
+    }
+}
+
+std::deque<double> HistoryReader::getPriceHistory(const std::string& symbol, int period) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::deque<double> prices;
+    if (!connect()) return prices;
+
+    try {
+        pqxx::nontransaction n(*connection_);
+        pqxx::result res = n.exec_prepared("price_history", symbol, period);
+        for (auto row : res) {
+            prices.push_back(std::stod(row[0].c_str()));
+        }
+    } catch (const std::exception &e) {
+        std::cerr << "History reader: " << e.what() << std::endl;
+    }
+    return prices;
+}
+
+std::vector<std::pair<double, double>> HistoryReader::getRollupHistory(const std::string& symbol, const std::string& table, int span) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<std::pair<double, double>> points;
+    if (!connect()) return points;
+
+    try {
+        pqxx::nontransaction n(*connection_);
+        pqxx::result res = n.exec_prepared(table, symbol, span);
+        for (auto row : res) {
+            points.emplace_back(std::stod(row[0].c_str()), std::stod(row[1].c_str()));
+        }
+    } catch (const std::exception &e) {
+        std::cerr << "History reader: " << e.what() << std::endl;
+    }
+    return points;
+}
+
+bool HistoryReader::stream(const std::string& table, const std::vector<std::string>& symbols, long long from, long long to, int chunkSize,
+                           const std::function<bool(long long time, const std::string& symbol, double price)>& visit) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!connect() || symbols.empty()) return false;
+
+    bool raw = table == DB_TABLE;
+    std::string timeColumn = raw ? "time" : "bucket";
+    try {
+        // a cursor only lives as long as its transaction, it is held for the whole stream
+        pqxx::work W(*connection_);
+        std::string symbolList;
+        for (const auto& symbol : symbols) {
+            symbolList += std::string(symbolList.empty() ? "" : ", ") + W.quote(symbol);
+        }
+        W.exec("DECLARE history_stream NO SCROLL CURSOR FOR \
+                SELECT EXTRACT(EPOCH FROM " + timeColumn + "::TIMESTAMPTZ) * 1000, symbol, " + (raw ? "price" : "close") + " \
+                FROM " + table + " \
+                WHERE " + timeColumn + " BETWEEN TO_TIMESTAMP(" + std::to_string(from) + ") AND TO_TIMESTAMP(" + std::to_string(to) + ") \
+                AND symbol IN (" + symbolList + ") \
+                ORDER BY " + timeColumn + ";");
+
+        while (true) {
+            pqxx::result res = W.exec("FETCH " + std::to_string(chunkSize) + " FROM history_stream;");
+            if (res.empty()) break;
+
+            for (auto row : res) {
+                if (!visit(std::llround(std::stod(row[0].c_str())), row[1].c_str(), std::stod(row[2].c_str()))) {
+                    return true;
+                }
+            }
+        }
+        W.exec("CLOSE history_stream;");
+    } catch (const std::exception &e) {
+        std::cerr << "History reader: " << e.what() << std::endl;
+        return false;
+    }
+    return true;
+}
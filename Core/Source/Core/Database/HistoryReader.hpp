@@ -0,0 +1,38 @@
+#ifndef HISTORY_READER_HPP
+#define HISTORY_READER_HPP
+
+#include <pqxx/pqxx>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+#include "Core/Database/DataStorage.hpp"
+
+// Read-only path to the price history for external readers. It has its own
+// connection and lock, so their queries never wait on dbMutex or hold it
+// while the ticker loads its charts, and it only runs prepared statements,
+// symbols from a request never end up in SQL text.
+class HistoryReader {
+public:
+    HistoryReader() = default;
+
+    std::deque<double> getPriceHistory(const std::string& symbol, int period);
+    std::vector<std::pair<double, double>> getRollupHistory(const std::string& symbol, const std::string& table, int span);
+
+    // Visits the samples of DB_TABLE, or the closes of a rollup table, of [from, to] in seconds in
+    // time order. Rows come through a server-side cursor chunkSize at a time, so memory stays flat
+    // however long the range. The visitor returns false to stop early.
+    bool stream(const std::string& table, const std::vector<std::string>& symbols, long long from, long long to, int chunkSize,
+                const std::function<bool(long long time, const std::string& symbol, double price)>& visit);
+
+private:
+    bool connect();
+
+    std::unique_ptr<pqxx::connection> connection_;
+    std::mutex mutex_;
+};
+
+#endif // HISTORY_READER_HPP
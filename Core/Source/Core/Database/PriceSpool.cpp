@@ -0,0 +1,271 @@
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <fcntl.h>
+#include <unistd.h>
+#include "PriceSpool.hpp"
+
+namespace fs = std::filesystem;
+
+namespace {
+    constexpr uint32_t SPOOL_VERSION = 1;
+    constexpr uint32_t SPOOL_MAX_SYMBOL = 256;
+
+    bool writeAll(int fd, const char* data, size_t size) {
+        while (size > 0) {
+            ssize_t written = write(fd, data, size);
+            if (written < 0) {
+                if (errno == EINTR) continue;
+                return false;
+            }
+            data += written;
+            size -= written;
+        }
+        return true;
+    }
+}
+
+PriceSpool::PriceSpool(const std::string& fileName) : fileName_(fileName) {}
+
+PriceSpool::~PriceSpool() {
+    if (fd_ >= 0) {
+        close(fd_);
+    }
+}
+
+// FNV-1a
+uint32_t PriceSpool::checksum(const SpoolRecordHeader& header, const std::string& apiSymbol) {
+    uint32_t hash = 2166136261u;
+    auto mix = [&hash](const void* data, size_t size) {
+        const auto* bytes = static_cast<const uint8_t*>(data);
+        for (size_t i = 0; i < size; i += 1) {
+            hash = (hash ^ bytes[i]) * 16777619u;
+        }
+    };
+    mix(&header, offsetof(SpoolRecordHeader, checksum));
+    mix(apiSymbol.data(), apiSymbol.size());
+    return hash;
+}
+
+void PriceSpool::appendRecord(std::string& buffer, const SpooledPrice& record) {
+    SpoolRecordHeader header{};
+    header.sequence = record.sequence;
+    header.time = record.time;
+    header.price = record.price;
+    header.symbolLength = record.apiSymbol.size();
+    header.checksum = checksum(header, record.apiSymbol);
+    buffer.append(reinterpret_cast<const char*>(&header), sizeof(header));
+    buffer.append(record.apiSymbol);
+}
+
+// Loads what the last run left unconfirmed, on first use.
+bool PriceSpool::open() {
+    if (opened_) return fd_ >= 0;
+    opened_ = true;
+
+    fd_ = ::open(fileName_.c_str(), O_RDWR | O_CREAT | O_APPEND, 0644);
+    if (fd_ < 0) {
+        std::cerr << "Could not open price spool " << fileName_ << ": " << std::strerror(errno) << ", keeping it in memory" << std::endl;
+        return false;
+    }
+
+    std::string contents;
+    char chunk[65536];
+    ssize_t bytes;
+    while ((bytes = read(fd_, chunk, sizeof(chunk))) > 0) {
+        contents.append(chunk, bytes);
+    }
+
+    SpoolFileHeader fileHeader;
+    if (contents.size() < sizeof(fileHeader) ||
+        (std::memcpy(&fileHeader, contents.data(), sizeof(fileHeader)), fileHeader.magic != SPOOL_MAGIC || fileHeader.version != SPOOL_VERSION)) {
+        if (!contents.empty()) {
+            std::cerr << "Ignoring corrupt price spool " << fileName_ << std::endl;
+        }
+        rewrite({});
+        return fd_ >= 0;
+    }
+
+    anchored_ = fileHeader.baseSequence != 0;
+    nextSequence_ = std::max<uint64_t>(fileHeader.baseSequence, 1);
+    size_t offset = sizeof(fileHeader);
+    while (offset + sizeof(SpoolRecordHeader) <= contents.size()) {
+        SpoolRecordHeader header;
+        std::memcpy(&header, contents.data() + offset, sizeof(header));
+        if (header.symbolLength > SPOOL_MAX_SYMBOL || offset + sizeof(header) + header.symbolLength > contents.size()) break;
+
+        std::string apiSymbol(contents.data() + offset + sizeof(header), header.symbolLength);
+        if (header.checksum != checksum(header, apiSymbol) || header.sequence < nextSequence_) break;
+
+        pending_.push_back(SpooledPrice{header.sequence, header.time, std::move(apiSymbol), header.price});
+        nextSequence_ = header.sequence + 1;
+        lastTime_ = header.time;
+        offset += sizeof(header) + header.symbolLength;
+    }
+
+    // a crash in the middle of an append leaves a torn record, the batch was never confirmed
+    if (offset < contents.size()) {
+        std::cerr << "Cutting " << contents.size() - offset << " torn bytes off the price spool" << std::endl;
+        if (ftruncate(fd_, offset) != 0) {
+            std::cerr << "Could not truncate price spool: " << std::strerror(errno) << std::endl;
+        }
+    }
+    size_ = offset;
+    syncedSequence_ = nextSequence_ - 1;
+
+    if (!pending_.empty()) {
+        std::cout << "Price spool holds " << pending_.size() << " prices not confirmed by the database" << std::endl;
+    }
+    return true;
+}
+
+// Written next to the spool and renamed, a crash leaves either the old or the new file.
+bool PriceSpool::rewrite(const std::deque<SpooledPrice>& records) {
+    std::string buffer;
+    uint64_t baseSequence = !anchored_ ? 0 : records.empty() ? nextSequence_ : records.front().sequence;
+    SpoolFileHeader header{SPOOL_MAGIC, SPOOL_VERSION, baseSequence};
+    buffer.append(reinterpret_cast<const char*>(&header), sizeof(header));
+    for (const auto& record : records) {
+        appendRecord(buffer, record);
+    }
+
+    std::string tmpName = fileName_ + ".tmp";
+    int fd = ::open(tmpName.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    bool written = fd >= 0 && writeAll(fd, buffer.data(), buffer.size()) && fdatasync(fd) == 0;
+    if (fd >= 0) close(fd);
+
+    std::error_code error;
+    if (written) {
+        fs::rename(tmpName, fileName_, error);
+    }
+    if (!written || error) {
+        std::cerr << "Could not rewrite price spool " << fileName_ << ": " << (error ? error.message() : std::strerror(errno)) << std::endl;
+        return false;
+    }
+
+    // the rename itself is only durable once the directory is synced
+    fs::path directory = fs::path(fileName_).parent_path();
+    int directoryFd = ::open(directory.empty() ? "." : directory.c_str(), O_RDONLY | O_DIRECTORY);
+    if (directoryFd >= 0) {
+        fsync(directoryFd);
+        close(directoryFd);
+    }
+
+    if (fd_ >= 0) close(fd_);
+    fd_ = ::open(fileName_.c_str(), O_RDWR | O_APPEND);
+    size_ = buffer.size();
+    syncedSequence_ = nextSequence_ - 1;
+    return fd_ >= 0;
+}
+
+void PriceSpool::append(const std::vector<std::pair<std::string, double>>& prices, long long time) {
+    if (prices.empty()) return;
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    open();
+
+    for (const auto& [apiSymbol, price] : prices) {
+        pending_.push_back(SpooledPrice{nextSequence_++, time, apiSymbol.substr(0, SPOOL_MAX_SYMBOL), price});
+    }
+    lastTime_ = time;
+    if (fd_ < 0) return;
+
+    // one write and one sync for the batch, and for earlier ones a failed append left in memory
+    auto unsynced = pending_.end();
+    while (unsynced != pending_.begin() && std::prev(unsynced)->sequence > syncedSequence_) {
+        --unsynced;
+    }
+    std::string buffer;
+    for (auto record = unsynced; record != pending_.end(); ++record) {
+        appendRecord(buffer, *record);
+    }
+
+    if (!writeAll(fd_, buffer.data(), buffer.size()) || fdatasync(fd_) != 0) {
+        std::cerr << "Could not write price spool " << fileName_ << ": " << std::strerror(errno) << std::endl;
+
+        // a torn record would end the file for the next open, records appended after it included
+        if (ftruncate(fd_, size_) != 0) {
+            std::cerr << "Could not truncate price spool, keeping it in memory: " << std::strerror(errno) << std::endl;
+            close(fd_);
+            fd_ = -1;
+        }
+        return;
+    }
+    size_ += buffer.size();
+    syncedSequence_ = nextSequence_ - 1;
+}
+
+std::vector<SpooledPrice> PriceSpool::pending(size_t limit) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    open();
+    size_t count = std::min(limit, pending_.size());
+    return std::vector<SpooledPrice>(pending_.begin(), pending_.begin() + count);
+}
+
+void PriceSpool::acknowledge(uint64_t sequence) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    open();
+    while (!pending_.empty() && pending_.front().sequence <= sequence) {
+        pending_.pop_front();
+    }
+    // numbering continues after the database's, even when the spool file was removed
+    nextSequence_ = std::max(nextSequence_, sequence + 1);
+
+    if (pending_.empty() && size_ >= SPOOL_COMPACT_SIZE) {
+        rewrite(pending_);
+    }
+}
+
+bool PriceSpool::resume(uint64_t sequence) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    open();
+    if (anchored_) {
+        while (!pending_.empty() && pending_.front().sequence <= sequence) {
+            pending_.pop_front();
+        }
+        nextSequence_ = std::max(nextSequence_, sequence + 1);
+        return true;
+    }
+
+    // numbered from 1 without the file of an earlier run, none of them can be in the database yet
+    uint64_t shift = pending_.empty() || pending_.front().sequence > sequence ? 0 : sequence + 1 - pending_.front().sequence;
+    for (auto& record : pending_) {
+        record.sequence += shift;
+    }
+    syncedSequence_ += shift;
+    nextSequence_ = std::max(nextSequence_ + shift, sequence + 1);
+
+    // the file keeps the old numbers and stays unanchored until it is rewritten, a restart moves them again
+    anchored_ = true;
+    if (!rewrite(pending_) && fd_ >= 0) {
+        anchored_ = false;
+        return false;
+    }
+    if (shift > 0) {
+        std::cout << "Renumbered " << pending_.size() << " spooled prices after the database's sequence " << sequence << std::endl;
+    }
+    return true;
+}
+
+size_t PriceSpool::backlog() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    open();
+    return pending_.size();
+}
+
+long long PriceSpool::lastTime() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    open();
+    return lastTime_;
+}
+
+void PriceSpool::clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    open();
+    pending_.clear();
+    lastTime_ = 0;
+    rewrite(pending_);
+}
@@ -0,0 +1,83 @@
+#ifndef PRICE_SPOOL_HPP
+#define PRICE_SPOOL_HPP
+
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#define SPOOL_COMPACT_SIZE 65536 // in bytes, a fully replayed spool is rewritten past this
+
+constexpr uint32_t SPOOL_MAGIC = 0x4c4f5053; // "SPOL"
+
+// Layout: file header, then one record header per price followed by its
+// symbol. Native endian, the spool is only read back by the machine that wrote it.
+struct SpoolFileHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t baseSequence;   // sequence of the first record written after the last compaction,
+                             // 0 while the numbering was never matched with the database's
+};
+
+struct SpoolRecordHeader {
+    uint64_t sequence;
+    int64_t time;            // in milliseconds since epoch
+    double price;
+    uint32_t symbolLength;
+    uint32_t checksum;       // of the fields above and the symbol, a torn tail is cut off on open
+};
+
+struct SpooledPrice {
+    uint64_t sequence;
+    long long time;          // in milliseconds since epoch
+    std::string apiSymbol;
+    double price;
+};
+
+// Append-only write-ahead file of the stored prices. Every sample batch
+// lands here first with one write and one fdatasync, the database is
+// caught up from it in order, acknowledging by sequence number, so an
+// outage delays the history instead of losing it.
+class PriceSpool {
+public:
+    PriceSpool(const std::string& fileName);
+    ~PriceSpool();
+
+    // Kept in memory even when the disk refuses it, it is only lost with the process then.
+    void append(const std::vector<std::pair<std::string, double>>& prices, long long time);
+
+    // Oldest records not acknowledged yet, at most limit of them.
+    std::vector<SpooledPrice> pending(size_t limit);
+    // Every record up to the sequence is in the database.
+    void acknowledge(uint64_t sequence);
+    // The database's stored sequence, once per connection. Records numbered
+    // before it was ever known move above it instead of being acknowledged,
+    // false while their new numbers could not be written.
+    bool resume(uint64_t sequence);
+
+    size_t backlog();
+    long long lastTime();    // in milliseconds, 0 before the first record
+    void clear();
+
+private:
+    bool open();
+    bool rewrite(const std::deque<SpooledPrice>& records);
+    static uint32_t checksum(const SpoolRecordHeader& header, const std::string& apiSymbol);
+    static void appendRecord(std::string& buffer, const SpooledPrice& record);
+
+    std::string fileName_;
+    int fd_ = -1;
+    bool opened_ = false;
+    long long size_ = 0;                 // of the synced records, a failed append is cut back to it
+    uint64_t syncedSequence_ = 0;        // records after it are only in memory and written with the next append
+
+    std::deque<SpooledPrice> pending_;
+    uint64_t nextSequence_ = 1;
+    bool anchored_ = false;              // numbering continues the database's, a new or corrupt file starts unanchored
+    long long lastTime_ = 0;
+    std::mutex mutex_;
+};
+
+#endif // PRICE_SPOOL_HPP
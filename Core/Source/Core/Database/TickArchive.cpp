@@ -0,0 +1,329 @@
+#include <algorithm>
+#include <bit>
+#include <cctype>
+#include <cmath>
+#include <cstring>
+#include <ctime>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include "TickArchive.hpp"
+
+namespace fs = std::filesystem;
+
+namespace {
+    // worst case of one tick: '1111' + 32 bit delta-of-delta, '11' + 5 + 6 + 64 bit XOR
+    constexpr uint32_t MAX_TICK_BITS = 4 + 32 + 2 + 5 + 6 + 64;
+
+    void writeBits(uint8_t* payload, uint32_t& position, uint64_t value, int bits) {
+        for (int i = bits - 1; i >= 0; i -= 1) {
+            if ((value >> i) & 1) {
+                payload[position / 8] |= 0x80 >> (position % 8);
+            }
+            position += 1;
+        }
+    }
+
+    class BitReader {
+    public:
+        BitReader(const uint8_t* payload, uint32_t length) : payload_(payload), length_(length) {}
+
+        bool exhausted(int bits) const {
+            return position_ + bits > length_;
+        }
+
+        uint64_t read(int bits) {
+            uint64_t value = 0;
+            for (int i = 0; i < bits; i += 1) {
+                value = (value << 1) | ((payload_[position_ / 8] >> (7 - position_ % 8)) & 1);
+                position_ += 1;
+            }
+            return value;
+        }
+
+    private:
+        const uint8_t* payload_;
+        uint32_t length_;
+        uint32_t position_ = 0;
+    };
+
+    uint64_t bitsOf(double value) {
+        return std::bit_cast<uint64_t>(value);
+    }
+}
+
+TickArchive::TickArchive(const std::string& directory)
+    : directory_(directory), lastReport_(std::chrono::steady_clock::now()) {}
+
+void TickArchive::append(const std::string& apiSymbol, long long tradeTime, double price) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    OpenBlock& open = open_[apiSymbol];
+    if (open.header.count == 0) {
+        open.openedAt = time(nullptr);
+    }
+
+    if (!encode(open, tradeTime, price)) {
+        // block full, or a gap too long for the delta-of-delta encoding
+        seal(apiSymbol, open);
+        open = OpenBlock();
+        open.openedAt = time(nullptr);
+        encode(open, tradeTime, price);
+    }
+    ticks_ += 1;
+}
+
+// Gorilla encoding: timestamps as delta-of-delta in variable buckets, prices as
+// the XOR with the previous price, reusing the previous window of meaningful bits
+// when it still fits. Returns false when the tick does not fit into this block.
+bool TickArchive::encode(OpenBlock& open, int64_t time, double price) {
+    TickBlockHeader& header = open.header;
+    uint64_t bits = bitsOf(price);
+
+    if (header.count == 0) {
+        header.firstTime = time;
+        header.minTime = time;
+        header.maxTime = time;
+        header.firstPrice = price;
+        header.count = 1;
+        open.previousTime = time;
+        open.previousDelta = 0;
+        open.previousBits = bits;
+        return true;
+    }
+
+    int64_t delta = time - open.previousTime;
+    int64_t deltaOfDelta = delta - open.previousDelta;
+    if (deltaOfDelta < std::numeric_limits<int32_t>::min() || deltaOfDelta > std::numeric_limits<int32_t>::max()) return false;
+    if (header.bitLength + MAX_TICK_BITS > TICK_BLOCK_PAYLOAD * 8) return false;
+
+    uint8_t* payload = open.payload.data();
+    uint32_t& position = header.bitLength;
+    if (deltaOfDelta == 0) {
+        writeBits(payload, position, 0b0, 1);
+    } else if (deltaOfDelta >= -63 && deltaOfDelta <= 64) {
+        writeBits(payload, position, 0b10, 2);
+        writeBits(payload, position, deltaOfDelta + 63, 7);
+    } else if (deltaOfDelta >= -255 && deltaOfDelta <= 256) {
+        writeBits(payload, position, 0b110, 3);
+        writeBits(payload, position, deltaOfDelta + 255, 9);
+    } else if (deltaOfDelta >= -2047 && deltaOfDelta <= 2048) {
+        writeBits(payload, position, 0b1110, 4);
+        writeBits(payload, position, deltaOfDelta + 2047, 12);
+    } else {
+        writeBits(payload, position, 0b1111, 4);
+        writeBits(payload, position, static_cast<uint32_t>(static_cast<int32_t>(deltaOfDelta)), 32);
+    }
+
+    uint64_t xored = bits ^ open.previousBits;
+    if (xored == 0) {
+        writeBits(payload, position, 0b0, 1);
+    } else {
+        int leading = std::min(std::countl_zero(xored), 31);
+        int trailing = std::countr_zero(xored);
+        if (open.previousLeading >= 0 && leading >= open.previousLeading && trailing >= open.previousTrailing) {
+            int meaningful = 64 - open.previousLeading - open.previousTrailing;
+            writeBits(payload, position, 0b10, 2);
+            writeBits(payload, position, xored >> open.previousTrailing, meaningful);
+        } else {
+            int meaningful = 64 - leading - trailing;
+            writeBits(payload, position, 0b11, 2);
+            writeBits(payload, position, leading, 5);
+            writeBits(payload, position, meaningful - 1, 6);
+            writeBits(payload, position, xored >> trailing, meaningful);
+            open.previousLeading = leading;
+            open.previousTrailing = trailing;
+        }
+    }
+
+    header.count += 1;
+    header.minTime = std::min<int64_t>(header.minTime, time);
+    header.maxTime = std::max<int64_t>(header.maxTime, time);
+    open.previousTime = time;
+    open.previousDelta = delta;
+    open.previousBits = bits;
+    return true;
+}
+
+void TickArchive::decode(const Block& block, long long from, long long to,
+                         const std::function<void(long long time, double price)>& visit) {
+    TickBlockHeader header;
+    std::memcpy(&header, block.data(), sizeof(header));
+    if (header.magic != TICK_BLOCK_MAGIC || header.count == 0 || header.bitLength > TICK_BLOCK_PAYLOAD * 8) return;
+
+    int64_t time = header.firstTime;
+    int64_t delta = 0;
+    uint64_t bits = bitsOf(header.firstPrice);
+    int leading = 0;
+    int trailing = 0;
+    if (time >= from && time <= to) visit(time, header.firstPrice);
+
+    BitReader reader(block.data() + sizeof(header), header.bitLength);
+    for (uint32_t i = 1; i < header.count; i += 1) {
+        if (reader.exhausted(1)) return;
+
+        int64_t deltaOfDelta = 0;
+        if (reader.read(1) == 1) {
+            if (reader.read(1) == 0) {
+                deltaOfDelta = static_cast<int64_t>(reader.read(7)) - 63;
+            } else if (reader.read(1) == 0) {
+                deltaOfDelta = static_cast<int64_t>(reader.read(9)) - 255;
+            } else if (reader.read(1) == 0) {
+                deltaOfDelta = static_cast<int64_t>(reader.read(12)) - 2047;
+            } else {
+                deltaOfDelta = static_cast<int32_t>(static_cast<uint32_t>(reader.read(32)));
+            }
+        }
+        delta += deltaOfDelta;
+        time += delta;
+
+        if (reader.read(1) == 1) {
+            if (reader.read(1) == 1) {
+                leading = static_cast<int>(reader.read(5));
+                trailing = 64 - leading - (static_cast<int>(reader.read(6)) + 1);
+            }
+            bits ^= reader.read(64 - leading - trailing) << trailing;
+        }
+
+        if (time >= from && time <= to) visit(time, std::bit_cast<double>(bits));
+    }
+}
+
+void TickArchive::seal(const std::string& apiSymbol, const OpenBlock& open) {
+    if (open.header.count == 0) return;
+
+    sealed_.push_back({apiSymbol, compose(open)});
+    rawBytes_ += open.header.count * (sizeof(int64_t) + sizeof(double));
+    encodedBytes_ += sizeof(TickBlockHeader) + (open.header.bitLength + 7) / 8;
+}
+
+TickArchive::Block TickArchive::compose(const OpenBlock& open) {
+    Block block{};
+    std::memcpy(block.data(), &open.header, sizeof(TickBlockHeader));
+    std::memcpy(block.data() + sizeof(TickBlockHeader), open.payload.data(), open.payload.size());
+    return block;
+}
+
+void TickArchive::flush() {
+    std::vector<SealedBlock> sealed;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+
+        // quiet symbols are written out at least once per seal time
+        long long now = time(nullptr);
+        for (auto it = open_.begin(); it != open_.end();) {
+            if (it->second.header.count > 0 && now >= it->second.openedAt + TICK_ARCHIVE_SEAL_TIME) {
+                seal(it->first, it->second);
+                it = open_.erase(it);
+            } else {
+                ++it;
+            }
+        }
+        sealed.swap(sealed_);
+    }
+
+    if (!sealed.empty()) {
+        std::error_code error;
+        fs::create_directories(directory_, error);
+        if (error) {
+            std::cerr << "Could not create the tick archive directory " << directory_ << ": " << error.message() << std::endl;
+        }
+    }
+
+    auto writeStart = std::chrono::steady_clock::now();
+    for (const auto& [apiSymbol, block] : sealed) {
+        std::string dataPath = path(apiSymbol, ".ticks");
+        std::error_code error;
+        uintmax_t size = fs::exists(dataPath, error) ? fs::file_size(dataPath, error) : 0;
+
+        std::ofstream data(dataPath, std::ios::binary | std::ios::app);
+        data.write(reinterpret_cast<const char*>(block.data()), block.size());
+        data.close();
+        if (!data) {
+            std::cerr << "Could not write the tick archive of " << apiSymbol << std::endl;
+            continue;
+        }
+
+        // the index is appended after its block, a scan never sees an entry without data
+        TickBlockHeader header;
+        std::memcpy(&header, block.data(), sizeof(header));
+        TickBlockIndex entry{header.minTime, header.maxTime, header.count, static_cast<uint32_t>(size / TICK_BLOCK_SIZE)};
+        std::ofstream index(path(apiSymbol, ".idx"), std::ios::binary | std::ios::app);
+        index.write(reinterpret_cast<const char*>(&entry), sizeof(entry));
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    blocksWritten_ += sealed.size();
+    writeTime_ += std::chrono::steady_clock::now() - writeStart;
+
+    auto now = std::chrono::steady_clock::now();
+    if (now < lastReport_ + std::chrono::seconds(TICK_ARCHIVE_REPORT_TIME)) return;
+
+    double seconds = std::chrono::duration<double>(now - lastReport_).count();
+    std::cout << "Tick archive: " << static_cast<long long>(ticks_ / seconds) << " ticks/s"
+              << ", blocks written: " << blocksWritten_
+              << " in " << std::chrono::duration_cast<std::chrono::milliseconds>(writeTime_).count() << "ms";
+    if (encodedBytes_ > 0) {
+        std::cout << ", compression " << std::round(10.0 * rawBytes_ / encodedBytes_) / 10 << "x";
+    }
+    std::cout << std::endl;
+
+    ticks_ = 0;
+    rawBytes_ = 0;
+    encodedBytes_ = 0;
+    blocksWritten_ = 0;
+    writeTime_ = std::chrono::steady_clock::duration::zero();
+    lastReport_ = now;
+}
+
+void TickArchive::close() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (const auto& [apiSymbol, open] : open_) {
+            seal(apiSymbol, open);
+        }
+        open_.clear();
+    }
+    flush();
+}
+
+void TickArchive::scan(const std::string& apiSymbol, long long from, long long to,
+                       const std::function<void(long long time, double price)>& visit) {
+    // written blocks first, then the ones still in memory, in the order they were filled
+    std::ifstream index(path(apiSymbol, ".idx"), std::ios::binary);
+    std::ifstream data(path(apiSymbol, ".ticks"), std::ios::binary);
+    TickBlockIndex entry;
+    Block block;
+    while (index.read(reinterpret_cast<char*>(&entry), sizeof(entry))) {
+        if (entry.maxTime < from || entry.minTime > to) continue;
+
+        data.clear();
+        data.seekg(static_cast<std::streamoff>(entry.block) * TICK_BLOCK_SIZE);
+        if (data.read(reinterpret_cast<char*>(block.data()), block.size())) {
+            decode(block, from, to, visit);
+        }
+    }
+
+    std::vector<Block> pending;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (const auto& sealed : sealed_) {
+            if (sealed.apiSymbol == apiSymbol) pending.push_back(sealed.block);
+        }
+        auto open = open_.find(apiSymbol);
+        if (open != open_.end() && open->second.header.count > 0) {
+            pending.push_back(compose(open->second));
+        }
+    }
+    for (const auto& pendingBlock : pending) {
+        decode(pendingBlock, from, to, visit);
+    }
+}
+
+// symbols become file names, e.g. BINANCE:BTCUSDT -> archive/BINANCE_BTCUSDT.ticks
+std::string TickArchive::path(const std::string& apiSymbol, const std::string& extension) const {
+    std::string name = apiSymbol;
+    std::replace_if(name.begin(), name.end(), [](char c) { return !std::isalnum(static_cast<unsigned char>(c)) && c != '-' && c != '.'; }, '_');
+    return directory_ + "/" + name + extension;
+}
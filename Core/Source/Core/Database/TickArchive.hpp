@@ -0,0 +1,106 @@
+#ifndef TICK_ARCHIVE_HPP
+#define TICK_ARCHIVE_HPP
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "Core/GlobalParams.hpp"
+
+#define TICK_ARCHIVE_SEAL_TIME 3600 // in seconds
+#define TICK_ARCHIVE_REPORT_TIME 60 // in seconds
+
+constexpr uint32_t TICK_BLOCK_MAGIC = 0x4b4c4254; // "TBLK"
+constexpr size_t TICK_BLOCK_SIZE = 4096;
+
+// Fixed-size block of an archive file, the header followed by the encoded ticks.
+// The first tick is stored in the header, every later one as the
+// delta-of-delta of its timestamp and the XOR of its price with the previous one.
+struct TickBlockHeader {
+    uint32_t magic;
+    uint32_t count;
+    uint32_t bitLength;      // of the encoded ticks after the header
+    uint32_t reserved;
+    int64_t firstTime;       // in milliseconds since epoch
+    int64_t minTime;         // trades may arrive slightly out of order
+    int64_t maxTime;
+    double firstPrice;
+};
+
+constexpr size_t TICK_BLOCK_PAYLOAD = TICK_BLOCK_SIZE - sizeof(TickBlockHeader);
+
+// One entry per block in <symbol>.idx, a range scan only decodes the blocks it overlaps.
+struct TickBlockIndex {
+    int64_t minTime;
+    int64_t maxTime;
+    uint32_t count;
+    uint32_t block;          // position in <symbol>.ticks
+};
+
+// Append-only, compressed archive of every trade, one pair of files per
+// symbol under TICK_ARCHIVE_DIR. Feed threads append into an open block per
+// symbol in memory, full blocks are written out by the storage thread in
+// flush(), so the ingest path never touches the SD card.
+class TickArchive {
+public:
+    TickArchive(const std::string& directory);
+
+    // Any thread, at feed rate.
+    void append(const std::string& apiSymbol, long long tradeTime, double price);
+
+    // Storage thread: writes sealed blocks, seals blocks open for longer than
+    // TICK_ARCHIVE_SEAL_TIME and reports compression and throughput.
+    void flush();
+    // Seals and writes every open block, on shutdown.
+    void close();
+
+    // Visits the archived ticks of [from, to] in milliseconds, including the ones not yet written.
+    void scan(const std::string& apiSymbol, long long from, long long to,
+              const std::function<void(long long time, double price)>& visit);
+
+private:
+    using Block = std::array<uint8_t, TICK_BLOCK_SIZE>;
+
+    struct OpenBlock {
+        TickBlockHeader header{TICK_BLOCK_MAGIC, 0, 0, 0, 0, 0, 0, 0};
+        std::array<uint8_t, TICK_BLOCK_PAYLOAD> payload{};
+        long long openedAt = 0;      // in seconds, for the seal time
+        int64_t previousTime = 0;
+        int64_t previousDelta = 0;
+        uint64_t previousBits = 0;
+        int previousLeading = -1;    // -1 until a window was written
+        int previousTrailing = 0;
+    };
+
+    struct SealedBlock {
+        std::string apiSymbol;
+        Block block;
+    };
+
+    void seal(const std::string& apiSymbol, const OpenBlock& open);
+    static Block compose(const OpenBlock& open);
+    static bool encode(OpenBlock& open, int64_t time, double price);
+    std::string path(const std::string& apiSymbol, const std::string& extension) const;
+    static void decode(const Block& block, long long from, long long to,
+                       const std::function<void(long long time, double price)>& visit);
+
+    std::string directory_;
+
+    std::unordered_map<std::string, OpenBlock> open_;
+    std::vector<SealedBlock> sealed_;
+    std::mutex mutex_;
+
+    // since the last report
+    long long ticks_ = 0;
+    long long rawBytes_ = 0;        // 16 bytes per sealed tick
+    long long encodedBytes_ = 0;
+    long long blocksWritten_ = 0;
+    std::chrono::steady_clock::duration writeTime_ = std::chrono::steady_clock::duration::zero();
+    std::chrono::steady_clock::time_point lastReport_;
+};
+
+#endif // TICK_ARCHIVE_HPP
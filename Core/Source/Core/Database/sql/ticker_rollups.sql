@@ -0,0 +1,37 @@
+-- create rollup tables, one row per symbol and bucket
+CREATE TABLE IF NOT EXISTS ticker_rollup_5m (
+  symbol VARCHAR(100),
+  bucket TIMESTAMP,
+  open FLOAT,
+  high FLOAT,
+  low FLOAT,
+  close FLOAT,
+  PRIMARY KEY (symbol, bucket)
+);
+
+CREATE TABLE IF NOT EXISTS ticker_rollup_1h (LIKE ticker_rollup_5m INCLUDING ALL);
+CREATE TABLE IF NOT EXISTS ticker_rollup_1d (LIKE ticker_rollup_5m INCLUDING ALL);
+
+-- backfill from the existing raw history
+INSERT INTO ticker_rollup_5m
+SELECT symbol, bucket,
+       (ARRAY_AGG(price ORDER BY time))[1], MAX(price), MIN(price), (ARRAY_AGG(price ORDER BY time DESC))[1]
+FROM (SELECT symbol, price, time,
+             DATE_TRUNC('hour', time) + FLOOR(EXTRACT(MINUTE FROM time) / 5) * INTERVAL '5 minutes' AS bucket
+      FROM ticker_history) h
+GROUP BY symbol, bucket
+ON CONFLICT DO NOTHING;
+
+INSERT INTO ticker_rollup_1h
+SELECT symbol, DATE_TRUNC('hour', time),
+       (ARRAY_AGG(price ORDER BY time))[1], MAX(price), MIN(price), (ARRAY_AGG(price ORDER BY time DESC))[1]
+FROM ticker_history
+GROUP BY symbol, DATE_TRUNC('hour', time)
+ON CONFLICT DO NOTHING;
+
+INSERT INTO ticker_rollup_1d
+SELECT symbol, DATE_TRUNC('day', time),
+       (ARRAY_AGG(price ORDER BY time))[1], MAX(price), MIN(price), (ARRAY_AGG(price ORDER BY time DESC))[1]
+FROM ticker_history
+GROUP BY symbol, DATE_TRUNC('day', time)
+ON CONFLICT DO NOTHING;
@@ -4,10 +4,31 @@
 const std::string CONFIG_FILE = "config.cfg";
 const std::string LOGO_DIR = "logos";
 const std::string LOGO_EXT = ".png";
+const std::string LOGO_MANIFEST = "manifest.txt";
+const std::string PROVIDER_SEPARATOR = "@";
+const std::string WARM_START_FILE = "warm_start.bin";
+const std::string TICK_ARCHIVE_DIR = "archive";
+const std::string PRICE_SPOOL_FILE = "prices.spool";
+const std::string SIMULATION_SPOOL_FILE = "simulation.spool";
 #define ZERO_PRICE 0.0
 #define MISSING_PRICE -1
 #define PRICE_TIME_INTERVAL 60 // in seconds
 #define RECONNECTION_TRIGER_TIME 30 // in seconds
+#define FEED_SILENCE_TIME 20 // in seconds
+#define STALE_SYMBOL_TIME 120 // in seconds
+#define RECONNECT_BASE_DELAY 500 // in milliseconds
+#define RECONNECT_MAX_DELAY 60000 // in milliseconds
 #define ALLOWABLE_DISSYNCHRONIZATION_TIME 5 // in seconds
+#define STORAGE_CHECK_TIME 1 // in seconds
+#define NETWORK_CHECK_TIME 100 // in milliseconds
+#define SCENE_CHECK_TIME 200 // in milliseconds
+#define RENDER_REPORT_TIME 60 // in seconds
+#define WARM_START_SAVE_TIME 60 // in seconds
+#define COMPACTION_CHECK_TIME 3600 // in seconds
+#define HOT_SYMBOLS_AHEAD 2
+#define HISTORY_LOADS_PER_CHECK 8
+#define HISTORY_SCANS_PER_CHECK 64 // loaded charts checked for a reload per pass
+#define PLAYBACK_CHUNK_SIZE 1000 // rows per cursor fetch
+#define PLAYBACK_CHECK_TIME 100 // in milliseconds
 
 #endif // GlobalParams_HPP
\ No newline at end of file
@@ -20,4 +20,17 @@ void ImageManipulator::reduce(int width, int height){
     if ( ! success ) {
         std::cerr << "Error: Failed to save the resized image." << std::endl;
     }
-}
\ No newline at end of file
+}
+bool ImageManipulator::reduce(const std::vector<unsigned char>& encoded, int width, int height,
+                              std::vector<unsigned char>& reduced) {
+    Mat image = imdecode(encoded, IMREAD_COLOR);
+    if (image.empty()) {
+        std::cerr << "Error: Failed to decode the image." << std::endl;
+        return false;
+    }
+
+    Mat scaledImg;
+    resize(image, scaledImg, Size(width, height), INTER_LINEAR);
+
+    return imencode(".png", scaledImg, reduced);
+}
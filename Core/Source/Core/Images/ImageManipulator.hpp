@@ -1,14 +1,21 @@
 #ifndef ImageManipulator_HPP
 #define ImageManipulator_HPP
 
+#include <string>
+#include <vector>
+
 class ImageManipulator {
 
 public:
     ImageManipulator(std::string filename);
     void reduce(int width, int height);
 
+    // Decodes, resizes and re-encodes an image held in memory, without touching the disk.
+    static bool reduce(const std::vector<unsigned char>& encoded, int width, int height,
+                       std::vector<unsigned char>& reduced);
+
 private:
     std::string filename_;
 };
 
-#endif // ImageManipulator_HPP
\ No newline at end of file
+#endif // ImageManipulator_HPP
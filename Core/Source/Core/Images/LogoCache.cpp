@@ -0,0 +1,71 @@
+#include <opencv2/opencv.hpp>
+#include <filesystem>
+#include <iostream>
+#include "LogoCache.hpp"
+
+using namespace cv;
+namespace fs = std::filesystem;
+
+LogoCache* LogoCache::instance_ = nullptr;
+
+// singleton
+LogoCache* LogoCache::getInstance() {
+   if (instance_ == nullptr) {
+      instance_ = new LogoCache();
+   }
+   return instance_;
+}
+
+LogoCache::LogoCache() {}
+
+std::shared_ptr<const Sprite> LogoCache::get(const std::string& path) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = sprites_.find(path);
+        if (it != sprites_.end()) return it->second;
+    }
+
+    // decoded outside the lock, a duplicate decode is cheaper than blocking the renderer
+    auto sprite = load(path);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    sprites_[path] = sprite;
+    return sprite;
+}
+
+void LogoCache::put(const std::string& path, std::shared_ptr<const Sprite> sprite) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    sprites_[path] = sprite;
+}
+
+void LogoCache::invalidate(const std::string& path) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    sprites_.erase(path);
+}
+
+std::shared_ptr<const Sprite> LogoCache::load(const std::string& path) {
+    if (!fs::exists(fs::path{path})) {
+        std::cout << "Logo not found: " << path << std::endl;
+        return nullptr;
+    }
+
+    Mat image = imread(path, IMREAD_COLOR | IMREAD_IGNORE_ORIENTATION);
+    if (image.empty()) {
+        std::cerr << "Error: Failed to decode logo " << path << std::endl;
+        return nullptr;
+    }
+
+    auto sprite = std::make_shared<Sprite>();
+    sprite->width = image.cols;
+    sprite->height = image.rows;
+    sprite->rgb.reserve(static_cast<size_t>(image.cols) * image.rows * 3);
+    for (int y = 0; y < image.rows; y++) {
+        for (int x = 0; x < image.cols; x++) {
+            const Vec3b& pixel = image.at<Vec3b>(y, x);
+            sprite->rgb.push_back(pixel[2]);
+            sprite->rgb.push_back(pixel[1]);
+            sprite->rgb.push_back(pixel[0]);
+        }
+    }
+    return sprite;
+}
@@ -0,0 +1,42 @@
+#ifndef LOGO_CACHE_HPP
+#define LOGO_CACHE_HPP
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Decoded logo, row-major RGB.
+struct Sprite {
+    int width = 0;
+    int height = 0;
+    std::vector<uint8_t> rgb;
+};
+
+// Logos decoded once and shared by every renderer thread, instead of
+// being read back from disk each time a symbol is drawn.
+class LogoCache {
+
+public:
+    static LogoCache* getInstance();
+
+    std::shared_ptr<const Sprite> get(const std::string& path);
+    void put(const std::string& path, std::shared_ptr<const Sprite> sprite);
+    void invalidate(const std::string& path);
+
+private:
+    static LogoCache* instance_;   // The one, single instance
+    LogoCache(); // private constructor
+    LogoCache(const LogoCache&);
+    LogoCache& operator=(const LogoCache&);
+
+    std::shared_ptr<const Sprite> load(const std::string& path);
+
+    // missing logos are cached as nullptr until the file is invalidated
+    std::unordered_map<std::string, std::shared_ptr<const Sprite>> sprites_;
+    std::mutex mutex_;
+};
+
+#endif // LOGO_CACHE_HPP
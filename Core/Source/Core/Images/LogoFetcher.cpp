@@ -0,0 +1,152 @@
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <algorithm>
+#include "LogoFetcher.hpp"
+#include "ImageManipulator.hpp"
+#include "LogoCache.hpp"
+#include "Core/GlobalParams.hpp"
+
+using namespace web::http::client;
+namespace fs = std::filesystem;
+
+namespace {
+    // FNV-1a, only used to detect logos changed on disk
+    uint64_t hashBytes(const std::vector<unsigned char>& bytes) {
+        uint64_t hash = 14695981039346656037ULL;
+        for (unsigned char byte : bytes) {
+            hash ^= byte;
+            hash *= 1099511628211ULL;
+        }
+        return hash;
+    }
+
+    std::vector<unsigned char> readFile(const std::string& path) {
+        std::ifstream file(path, std::ios::binary);
+        return std::vector<unsigned char>(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    }
+}
+
+LogoFetcher::LogoFetcher(const std::string& logoUrl) : logoUrl_(logoUrl) {}
+
+AsyncTask LogoFetcher::fetchAll(Executor& executor, std::vector<std::string> logos, int size) {
+    // a change while downloading is picked up once the current pass is done
+    if (fetching_) {
+        queuedLogos_ = std::move(logos);
+        queuedSize_ = size;
+        co_return;
+    }
+    fetching_ = true;
+
+    fs::path logosPath{LOGO_DIR};
+
+    if (!fs::exists(logosPath)) {
+        fs::create_directory(logosPath);
+    }
+
+    while (true) {
+        loadManifest();
+
+        std::vector<std::string> missing;
+        for (const auto& logo : logos) {
+            if (!logo.empty() && !isUpToDate(logo, size)) {
+                missing.push_back(logo);
+            }
+        }
+
+        // at most LOGO_FETCH_CONCURRENCY requests are in flight
+        for (size_t first = 0; first < missing.size(); first += LOGO_FETCH_CONCURRENCY) {
+            std::vector<pplx::task<void>> fetches;
+            for (size_t i = first; i < std::min(first + LOGO_FETCH_CONCURRENCY, missing.size()); i += 1) {
+                const std::string logo = missing[i];
+                try {
+                    fetches.push_back(fetch(logo, size).then([logo](pplx::task<void> fetched) {
+                        try {
+                            fetched.get();
+                        } catch (const std::exception& e) {
+                            std::cerr << e.what() << "\n";
+                            std::cerr << "Logo " << logo << " does not exist on the website. Try adding 'Logo_Subs_list' to the config file.\n";
+                        }
+                    }));
+                } catch (const std::exception& e) {
+                    std::cerr << "Exception occurred: " << e.what() << std::endl;
+                }
+            }
+            co_await awaitTask(executor, pplx::when_all(fetches.begin(), fetches.end()));
+        }
+
+        saveManifest();
+
+        if (queuedLogos_.empty()) break;
+        logos = std::move(queuedLogos_);
+        size = queuedSize_;
+        queuedLogos_.clear();
+    }
+
+    fetching_ = false;
+}
+
+pplx::task<void> LogoFetcher::fetch(const std::string& logo, int size) {
+    http_client client(logoUrl_ + logo + LOGO_EXT);
+
+    return client.request(web::http::methods::GET).then([](web::http::http_response response) {
+        if (response.status_code() != web::http::status_codes::OK) {
+            throw std::runtime_error("Failed to download logo. Status code: " + std::to_string(response.status_code()));
+        }
+        return response.extract_vector();
+    }).then([this, logo, size](std::vector<unsigned char> body) {
+        std::vector<unsigned char> reduced;
+        if (!ImageManipulator::reduce(body, size, size, reduced)) {
+            throw std::runtime_error("Failed to resize logo " + logo);
+        }
+
+        // write next to the logo and rename, the renderer never sees a partial file
+        std::string logoPath = LOGO_DIR + "/" + logo + LOGO_EXT;
+        std::string tmpPath = logoPath + ".tmp";
+        {
+            std::ofstream file(tmpPath, std::ios::binary | std::ios::trunc);
+            file.write(reinterpret_cast<const char*>(reduced.data()), reduced.size());
+        }
+        fs::rename(tmpPath, logoPath);
+        LogoCache::getInstance()->invalidate(logoPath);
+
+        std::lock_guard<std::mutex> lock(manifestMutex_);
+        manifest_[logo] = ManifestEntry{size, reduced.size(), hashBytes(reduced)};
+        std::cout << "Logo downloaded successfully: " << logo << "\n";
+    });
+}
+
+bool LogoFetcher::isUpToDate(const std::string& logo, int size) {
+    std::string logoPath = LOGO_DIR + "/" + logo + LOGO_EXT;
+    if (!fs::exists(fs::path{logoPath})) return false;
+
+    std::lock_guard<std::mutex> lock(manifestMutex_);
+    auto it = manifest_.find(logo);
+    if (it == manifest_.end() || it->second.size != size) return false;
+
+    // cheap size check first, the hash only reads the few bytes of a small png
+    if (fs::file_size(logoPath) != it->second.bytes) return false;
+    return hashBytes(readFile(logoPath)) == it->second.hash;
+}
+
+void LogoFetcher::loadManifest() {
+    std::lock_guard<std::mutex> lock(manifestMutex_);
+    manifest_.clear();
+
+    std::ifstream file(LOGO_DIR + "/" + LOGO_MANIFEST);
+    std::string logo;
+    ManifestEntry entry;
+    while (file >> logo >> entry.size >> entry.bytes >> entry.hash) {
+        manifest_[logo] = entry;
+    }
+}
+
+void LogoFetcher::saveManifest() {
+    std::lock_guard<std::mutex> lock(manifestMutex_);
+
+    std::ofstream file(LOGO_DIR + "/" + LOGO_MANIFEST, std::ios::trunc);
+    for (const auto& [logo, entry] : manifest_) {
+        file << logo << " " << entry.size << " " << entry.bytes << " " << entry.hash << "\n";
+    }
+}
@@ -0,0 +1,45 @@
+#ifndef LOGO_FETCHER_HPP
+#define LOGO_FETCHER_HPP
+
+#include <cpprest/http_client.h>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "Core/Async/Coroutine.hpp"
+#include "Core/Async/Executor.hpp"
+
+constexpr int LOGO_FETCH_CONCURRENCY = 4;
+
+// Downloads logos with a bounded number of parallel requests, resizes them in
+// memory and records every processed file in a manifest, so that checking
+// logos on startup only compares file sizes and hashes. Downloads run as a
+// coroutine on the caller's executor, no thread waits for them.
+class LogoFetcher {
+public:
+    LogoFetcher(const std::string& logoUrl);
+
+    AsyncTask fetchAll(Executor& executor, std::vector<std::string> logos, int size);
+
+private:
+    struct ManifestEntry {
+        int size = 0;
+        uintmax_t bytes = 0;
+        uint64_t hash = 0;
+    };
+
+    pplx::task<void> fetch(const std::string& logo, int size);
+    bool isUpToDate(const std::string& logo, int size);
+    void loadManifest();
+    void saveManifest();
+
+    std::string logoUrl_;
+    bool fetching_ = false;             // only touched on the executor thread
+    std::vector<std::string> queuedLogos_;
+    int queuedSize_ = 0;
+    std::unordered_map<std::string, ManifestEntry> manifest_;
+    std::mutex manifestMutex_;
+};
+
+#endif // LOGO_FETCHER_HPP
@@ -0,0 +1,113 @@
+#include <algorithm>
+#include <ctime>
+#include <iostream>
+#include "AlertEngine.hpp"
+#include "Core/System/Clock.hpp"
+
+void AlertEngine::setRules(const std::vector<AlertRule>& rules) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    // debounce survives a rule push that keeps the rule
+    std::unordered_map<std::string, long long> lastFired;
+    for (const auto& state : rules_) {
+        lastFired[state.rule.id] = state.lastFired;
+    }
+
+    rules_.clear();
+    for (auto& [apiSymbol, symbol] : symbols_) {
+        symbol.priceLevels.clear();
+        symbol.percentLevels.clear();
+    }
+
+    for (const auto& rule : rules) {
+        size_t index = rules_.size();
+        rules_.push_back({rule, lastFired.count(rule.id) ? lastFired[rule.id] : 0});
+
+        SymbolRules& symbol = symbols_[rule.apiSymbol];
+        if (rule.type == AlertType::PercentMove) {
+            symbol.percentLevels.emplace(rule.value, index);
+        } else {
+            symbol.priceLevels.emplace(rule.value, index);
+        }
+    }
+    ruleCount_ = rules_.size();
+
+    std::cout << "Alert rules loaded: " << rules_.size() << std::endl;
+}
+
+void AlertEngine::setReference(const std::string& apiSymbol, double referencePrice) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    symbols_[apiSymbol].referencePrice = referencePrice;
+}
+
+void AlertEngine::onTick(const std::string& apiSymbol, double price, long long tradeTime) {
+    if (ruleCount_ == 0) return;
+
+    auto start = std::chrono::steady_clock::now();
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    auto it = symbols_.find(apiSymbol);
+    if (it == symbols_.end()) return;
+    SymbolRules& symbol = it->second;
+
+    if (symbol.hasPrice && price != symbol.lastPrice) {
+        checkLevels(symbol.priceLevels, symbol.lastPrice, price, apiSymbol, price, tradeTime);
+
+        if (symbol.referencePrice > 0 && !symbol.percentLevels.empty()) {
+            double fromPercent = (symbol.lastPrice - symbol.referencePrice) / symbol.referencePrice * 100;
+            double toPercent = (price - symbol.referencePrice) / symbol.referencePrice * 100;
+            checkLevels(symbol.percentLevels, fromPercent, toPercent, apiSymbol, price, tradeTime);
+        }
+    }
+    symbol.lastPrice = price;
+    symbol.hasPrice = true;
+
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    ticks_ += 1;
+    evaluation_ += elapsed;
+    worstEvaluation_ = std::max(worstEvaluation_, elapsed);
+}
+
+void AlertEngine::checkLevels(const std::multimap<double, size_t>& levels, double from, double to,
+                              const std::string& apiSymbol, double price, long long tradeTime) {
+    bool rising = to > from;
+
+    // levels in (from, to] when rising, [to, from) when falling
+    auto begin = rising ? levels.upper_bound(from) : levels.lower_bound(to);
+    auto end = rising ? levels.upper_bound(to) : levels.lower_bound(from);
+
+    long long now = Clock::getInstance()->now();
+    for (auto level = begin; level != end; ++level) {
+        RuleState& state = rules_[level->second];
+        const AlertRule& rule = state.rule;
+
+        bool matches = rule.type == AlertType::Cross ||
+                       (rule.type == AlertType::Above && rising) ||
+                       (rule.type == AlertType::Below && !rising) ||
+                       (rule.type == AlertType::PercentMove && (rule.value >= 0) == rising);
+        if (!matches || now < state.lastFired + rule.debounce) continue;
+
+        state.lastFired = now;
+        fired_.push_back({rule.id, apiSymbol, price, tradeTime});
+    }
+}
+
+std::vector<FiredAlert> AlertEngine::takeFired() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<FiredAlert> fired;
+    fired.swap(fired_);
+    return fired;
+}
+
+void AlertEngine::report() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (ticks_ == 0) return;
+
+    std::cout << "Alert rules: " << rules_.size()
+              << ", ticks checked: " << ticks_
+              << ", average check: " << std::chrono::duration_cast<std::chrono::nanoseconds>(evaluation_).count() / ticks_ << "ns"
+              << ", worst check: " << std::chrono::duration_cast<std::chrono::nanoseconds>(worstEvaluation_).count() << "ns" << std::endl;
+    ticks_ = 0;
+    evaluation_ = std::chrono::steady_clock::duration::zero();
+    worstEvaluation_ = std::chrono::steady_clock::duration::zero();
+}
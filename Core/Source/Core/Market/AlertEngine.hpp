@@ -0,0 +1,80 @@
+#ifndef ALERT_ENGINE_HPP
+#define ALERT_ENGINE_HPP
+
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+constexpr int ALERT_DEFAULT_DEBOUNCE = 300; // in seconds
+
+enum class AlertType {
+    Above,        // price rises through value
+    Below,        // price falls through value
+    Cross,        // price passes value in either direction
+    PercentMove   // daily gain passes value percent, upwards when positive, downwards when negative
+};
+
+struct AlertRule {
+    std::string id;
+    std::string apiSymbol;
+    AlertType type;
+    double value;
+    int debounce = ALERT_DEFAULT_DEBOUNCE; // in seconds
+};
+
+struct FiredAlert {
+    std::string id;
+    std::string apiSymbol;
+    double price;
+    long long time;
+};
+
+// Rules are indexed per symbol in maps sorted by their trigger level, a tick
+// only visits the rules whose level lies between the previous and the new
+// price, so checking it costs O(log n) in the number of rules.
+// Alerts fire on crossings only, a level already passed when the first
+// price arrives stays quiet.
+class AlertEngine {
+public:
+    void setRules(const std::vector<AlertRule>& rules);
+    void setReference(const std::string& apiSymbol, double referencePrice);
+    void onTick(const std::string& apiSymbol, double price, long long tradeTime);
+
+    std::vector<FiredAlert> takeFired();
+
+    void report();
+
+private:
+    struct RuleState {
+        AlertRule rule;
+        long long lastFired = 0;
+    };
+
+    struct SymbolRules {
+        std::multimap<double, size_t> priceLevels;    // level -> index in rules_
+        std::multimap<double, size_t> percentLevels;
+        double lastPrice = 0;
+        double referencePrice = 0;
+        bool hasPrice = false;
+    };
+
+    void checkLevels(const std::multimap<double, size_t>& levels, double from, double to,
+                     const std::string& apiSymbol, double price, long long tradeTime);
+
+    std::vector<RuleState> rules_;
+    std::unordered_map<std::string, SymbolRules> symbols_;
+    std::vector<FiredAlert> fired_;
+    std::atomic<size_t> ruleCount_ = 0;
+
+    long long ticks_ = 0;
+    std::chrono::steady_clock::duration evaluation_ = std::chrono::steady_clock::duration::zero();
+    std::chrono::steady_clock::duration worstEvaluation_ = std::chrono::steady_clock::duration::zero();
+
+    std::mutex mutex_;
+};
+
+#endif // ALERT_ENGINE_HPP
@@ -0,0 +1,56 @@
+#include <algorithm>
+#include <cmath>
+#include "Downsample.hpp"
+
+std::deque<double> downsampleLttb(const std::vector<std::pair<double, double>>& points, size_t threshold) {
+    std::deque<double> sampled;
+    if (threshold >= points.size() || threshold < 3) {
+        for (const auto& point : points) {
+            sampled.push_back(point.second);
+        }
+        while (sampled.size() > threshold) {
+            sampled.pop_front();
+        }
+        return sampled;
+    }
+
+    // the first and last points are always kept, the rest is split into threshold - 2 buckets
+    double bucketSize = static_cast<double>(points.size() - 2) / (threshold - 2);
+    size_t selected = 0;
+    sampled.push_back(points[0].second);
+
+    for (size_t bucket = 0; bucket < threshold - 2; bucket += 1) {
+        size_t start = static_cast<size_t>(std::floor(bucket * bucketSize)) + 1;
+        size_t end = static_cast<size_t>(std::floor((bucket + 1) * bucketSize)) + 1;
+
+        // average of the next bucket stands in for the third triangle point
+        size_t nextStart = end;
+        size_t nextEnd = std::min(static_cast<size_t>(std::floor((bucket + 2) * bucketSize)) + 1, points.size());
+        double averageTime = 0;
+        double averagePrice = 0;
+        for (size_t i = nextStart; i < nextEnd; i += 1) {
+            averageTime += points[i].first;
+            averagePrice += points[i].second;
+        }
+        averageTime /= nextEnd - nextStart;
+        averagePrice /= nextEnd - nextStart;
+
+        const auto& anchor = points[selected];
+        double maxArea = -1;
+        size_t next = start;
+        for (size_t i = start; i < end; i += 1) {
+            double area = std::abs((anchor.first - averageTime) * (points[i].second - anchor.second) -
+                                   (anchor.first - points[i].first) * (averagePrice - anchor.second));
+            if (area > maxArea) {
+                maxArea = area;
+                next = i;
+            }
+        }
+
+        sampled.push_back(points[next].second);
+        selected = next;
+    }
+
+    sampled.push_back(points.back().second);
+    return sampled;
+}
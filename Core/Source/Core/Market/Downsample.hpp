@@ -0,0 +1,14 @@
+#ifndef DOWNSAMPLE_HPP
+#define DOWNSAMPLE_HPP
+
+#include <deque>
+#include <utility>
+#include <vector>
+
+// Largest-triangle-three-buckets: keeps the first and last point and from
+// every bucket in between the point spanning the largest triangle with its
+// neighbours, so spikes survive the reduction to the chart width.
+// Points are (time, price) sorted by time; returns at most threshold prices.
+std::deque<double> downsampleLttb(const std::vector<std::pair<double, double>>& points, size_t threshold);
+
+#endif // DOWNSAMPLE_HPP
@@ -0,0 +1,64 @@
+#include <algorithm>
+#include <cmath>
+#include "Indicators.hpp"
+
+IndicatorValues IndicatorEngine::update(double price) {
+    IndicatorValues values;
+    if (price == MISSING_PRICE) return values;
+
+    window_.push_back(price);
+    if (window_.size() > SMA_PERIOD) {
+        window_.pop_front();
+    }
+    if (window_.size() == SMA_PERIOD) {
+        double sum = 0;
+        for (double sample : window_) sum += sample;
+        values.sma = sum / SMA_PERIOD;
+
+        // deviations from the mean first, squares of the raw prices would cancel
+        double squares = 0;
+        for (double sample : window_) squares += (sample - values.sma) * (sample - values.sma);
+        double deviation = std::sqrt(std::max(0.0, squares / SMA_PERIOD));
+        values.upperBand = values.sma + BOLLINGER_WIDTH * deviation;
+        values.lowerBand = values.sma - BOLLINGER_WIDTH * deviation;
+    }
+
+    emaSamples_ += 1;
+    if (emaSamples_ <= EMA_PERIOD) {
+        ema_ += price / EMA_PERIOD;
+    } else {
+        ema_ += (price - ema_) * 2.0 / (EMA_PERIOD + 1);
+    }
+    if (emaSamples_ >= EMA_PERIOD) {
+        values.ema = ema_;
+    }
+
+    if (lastPrice_ != MISSING_PRICE) {
+        double change = price - lastPrice_;
+        double gain = std::max(change, 0.0);
+        double loss = std::max(-change, 0.0);
+
+        rsiChanges_ += 1;
+        if (rsiChanges_ <= RSI_PERIOD) {
+            averageGain_ += gain / RSI_PERIOD;
+            averageLoss_ += loss / RSI_PERIOD;
+        } else {
+            averageGain_ = (averageGain_ * (RSI_PERIOD - 1) + gain) / RSI_PERIOD;
+            averageLoss_ = (averageLoss_ * (RSI_PERIOD - 1) + loss) / RSI_PERIOD;
+        }
+        if (rsiChanges_ >= RSI_PERIOD) {
+            if (averageLoss_ == 0) {
+                values.rsi = averageGain_ == 0 ? 50 : 100;
+            } else {
+                values.rsi = 100 - 100 / (1 + averageGain_ / averageLoss_);
+            }
+        }
+    }
+    lastPrice_ = price;
+
+    return values;
+}
+
+void IndicatorEngine::reset() {
+    *this = IndicatorEngine();
+}
@@ -0,0 +1,48 @@
+#ifndef INDICATORS_HPP
+#define INDICATORS_HPP
+
+#include <deque>
+#include <string>
+#include "Core/GlobalParams.hpp"
+
+constexpr int SMA_PERIOD = 20;
+constexpr int EMA_PERIOD = 9;
+constexpr int RSI_PERIOD = 14;
+constexpr int BOLLINGER_PERIOD = SMA_PERIOD;
+constexpr double BOLLINGER_WIDTH = 2.0; // in standard deviations
+
+// Indicator readings for one chart sample, MISSING_PRICE until enough samples were seen.
+struct IndicatorValues {
+    double sma = MISSING_PRICE;
+    double ema = MISSING_PRICE;
+    double rsi = MISSING_PRICE;
+    double upperBand = MISSING_PRICE;
+    double lowerBand = MISSING_PRICE;
+};
+
+// Running state of the indicators of one symbol. Every sample updates them
+// in constant time, the averages recursively and the bands from the last
+// SMA_PERIOD samples, nothing is recomputed from the chart.
+class IndicatorEngine {
+public:
+    IndicatorValues update(double price);
+    void reset();
+
+private:
+    // simple moving average and Bollinger bands share the window
+    // Both are summed over the window on every sample. Running sums drift, and
+    // a running sum of squares cancels catastrophically at BTC prices.
+    std::deque<double> window_;
+
+    // seeded with the average of the first EMA_PERIOD samples
+    double ema_ = 0;
+    int emaSamples_ = 0;
+
+    // Wilder's smoothing, seeded with the average of the first RSI_PERIOD changes
+    double lastPrice_ = MISSING_PRICE;
+    double averageGain_ = 0;
+    double averageLoss_ = 0;
+    int rsiChanges_ = 0;
+};
+
+#endif // INDICATORS_HPP
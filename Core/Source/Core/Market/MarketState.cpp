@@ -0,0 +1,348 @@
+#include <algorithm>
+#include <atomic>
+#include <ctime>
+#include "MarketState.hpp"
+#include "Core/System/Clock.hpp"
+
+MarketState::MarketState(int chartLength) : chartLength_(chartLength), changes_(SNAPSHOT_CHANGE_LOG_SIZE) {
+    published_ = std::make_shared<const MarketSnapshot>();
+}
+
+void MarketState::setSymbols(const std::vector<std::string>& subs,
+                             const std::vector<std::string>& apiSubs,
+                             const std::vector<std::string>& logoSubs) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    std::vector<SymbolSnapshot> symbols;
+    std::unordered_map<std::string, size_t> index;
+    std::vector<double> pendingPrices;
+    for (size_t i = 0; i < apiSubs.size(); i += 1) {
+        // symbols that stay subscribed keep their prices and charts
+        SymbolSnapshot* existing = find(apiSubs[i]);
+        SymbolSnapshot symbol;
+        pendingPrices.push_back(MISSING_PRICE);
+        if (existing != nullptr) {
+            symbol = *existing;
+            pendingPrices.back() = pendingPrices_[existing - symbols_.data()];
+        } else {
+            symbol.apiName = apiSubs[i];
+            symbol.lastTradeTime = Clock::getInstance()->now();
+        }
+        symbol.hot = isHot(symbol.apiName);
+        symbol.name = i < subs.size() ? subs[i] : apiSubs[i];
+        symbol.logo = i < logoSubs.size() ? logoSubs[i] : "";
+        symbol.logoPath = symbol.logo.empty() ? "" : LOGO_DIR + "/" + symbol.logo + LOGO_EXT;
+        index[symbol.apiName] = symbols.size();
+        symbols.push_back(symbol);
+    }
+    symbols_.swap(symbols);
+    index_.swap(index);
+    pendingPrices_.swap(pendingPrices);
+
+    // indices moved, every snapshot is copied whole once
+    version_ += 1;
+    changesSince_ = version_;
+    for (size_t i = 0; i < symbols_.size(); i += 1) {
+        symbols_[i].version = version_;
+    }
+    hotIndices_.clear();
+    for (const auto& apiSymbol : hot_) {
+        if (SymbolSnapshot* symbol = find(apiSymbol)) hotIndices_.push_back(symbol - symbols_.data());
+    }
+    queueHistoryLoads();
+
+    std::erase_if(indicatorEngines_, [this](const auto& engine) { return index_.count(engine.first) == 0; });
+}
+
+void MarketState::updatePrice(const std::string& apiSymbol, double price, long long tradeTime) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    SymbolSnapshot* symbol = find(apiSymbol);
+    if (symbol == nullptr) return;
+
+    symbol->lastTradeTime = tradeTime;
+    if (!symbol->hot) {
+        pendingPrices_[symbol - symbols_.data()] = price;
+        return;
+    }
+    if (symbol->price == price) return;
+
+    symbol->price = price;
+    touch(*symbol);
+}
+
+// Only the symbols entering or leaving the hot set are visited, except when
+// leaving the start where every symbol is hot.
+void MarketState::setHotSymbols(const std::vector<std::string>& apiSymbols) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    previousHot_.swap(hot_);
+    hot_.assign(apiSymbols.begin(), apiSymbols.end());
+    if (previousHot_.empty() || hot_.empty()) {
+        for (auto& symbol : symbols_) {
+            updateHot(symbol);
+        }
+    } else {
+        for (const auto& apiSymbol : previousHot_) {
+            if (SymbolSnapshot* symbol = find(apiSymbol)) updateHot(*symbol);
+        }
+        for (const auto& apiSymbol : hot_) {
+            if (SymbolSnapshot* symbol = find(apiSymbol)) updateHot(*symbol);
+        }
+    }
+
+    hotIndices_.clear();
+    for (const auto& apiSymbol : hot_) {
+        if (SymbolSnapshot* symbol = find(apiSymbol)) hotIndices_.push_back(symbol - symbols_.data());
+    }
+}
+
+void MarketState::updateHot(SymbolSnapshot& symbol) {
+    bool hot = isHot(symbol.apiName);
+    if (symbol.hot == hot) return;
+
+    symbol.hot = hot;
+    // a symbol coming up on screen gets the trades it was not published for
+    size_t i = &symbol - symbols_.data();
+    if (hot && pendingPrices_[i] != MISSING_PRICE) {
+        symbol.price = pendingPrices_[i];
+        pendingPrices_[i] = MISSING_PRICE;
+    }
+    touch(symbol);
+}
+
+// Publishes the latest prices of the cold tier, called at sample boundaries.
+void MarketState::flushPrices() {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    for (size_t i = 0; i < symbols_.size(); i += 1) {
+        double price = pendingPrices_[i];
+        pendingPrices_[i] = MISSING_PRICE;
+        if (price == MISSING_PRICE || symbols_[i].price == price) continue;
+
+        symbols_[i].price = price;
+        touch(symbols_[i]);
+    }
+}
+
+void MarketState::setHistory(const std::string& apiSymbol, std::deque<double> chart,
+                             double lastStoredPrice, double referencePrice, bool liveChart) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    SymbolSnapshot* symbol = find(apiSymbol);
+    if (symbol == nullptr) return;
+
+    setChart(*symbol, std::move(chart));
+    symbol->lastStoredPrice = lastStoredPrice;
+    symbol->referencePrice = referencePrice;
+    symbol->historyLoaded = true;
+    symbol->liveChart = liveChart;
+    symbol->historyLoadedAt = Clock::getInstance()->now();
+    touch(*symbol);
+}
+
+// Shows a chart from the warm start snapshot, the history is still loaded
+// from the database afterwards and replaces it.
+void MarketState::restoreHistory(const std::string& apiSymbol, std::deque<double> chart,
+                                 double lastStoredPrice, double referencePrice) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    SymbolSnapshot* symbol = find(apiSymbol);
+    if (symbol == nullptr || symbol->historyLoaded) return;
+
+    setChart(*symbol, std::move(chart));
+    symbol->lastStoredPrice = lastStoredPrice;
+    symbol->referencePrice = referencePrice;
+    touch(*symbol);
+}
+
+void MarketState::appendSample(const std::string& apiSymbol, double price) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    SymbolSnapshot* symbol = find(apiSymbol);
+    if (symbol == nullptr || !symbol->historyLoaded || !symbol->liveChart) return;
+
+    // copy on write, snapshots already handed out keep the previous chart
+    auto chart = std::make_shared<std::deque<double>>(*symbol->chart);
+    chart->push_back(price);
+    if (chart->size() > chartLength_) {
+        chart->pop_front();
+    }
+    symbol->chart = chart;
+
+    // one constant time step per indicator, the chart is not walked again
+    auto indicators = std::make_shared<std::deque<IndicatorValues>>(*symbol->indicators);
+    indicators->push_back(indicatorEngines_[apiSymbol].update(price));
+    if (indicators->size() > chartLength_) {
+        indicators->pop_front();
+    }
+    symbol->indicators = indicators;
+    if (price != MISSING_PRICE) {
+        symbol->lastStoredPrice = price;
+    }
+    touch(*symbol);
+}
+
+void MarketState::clearHistory() {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    for (auto& symbol : symbols_) {
+        symbol.chart.reset();
+        symbol.indicators.reset();
+        symbol.referencePrice = ZERO_PRICE;
+        symbol.historyLoaded = false;
+        touch(symbol);
+    }
+    queueHistoryLoads();
+}
+
+void MarketState::clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    std::fill(pendingPrices_.begin(), pendingPrices_.end(), MISSING_PRICE);
+    for (auto& symbol : symbols_) {
+        symbol.price = MISSING_PRICE;
+        symbol.chart.reset();
+        symbol.indicators.reset();
+        symbol.referencePrice = ZERO_PRICE;
+        symbol.historyLoaded = false;
+        touch(symbol);
+    }
+    queueHistoryLoads();
+}
+
+// Indicators are replayed over a replaced chart once, later samples update them incrementally.
+void MarketState::setChart(SymbolSnapshot& symbol, std::deque<double> chart) {
+    while (chart.size() > chartLength_) {
+        chart.pop_front();
+    }
+
+    IndicatorEngine& engine = indicatorEngines_[symbol.apiName];
+    engine.reset();
+    auto indicators = std::make_shared<std::deque<IndicatorValues>>();
+    for (double sample : chart) {
+        indicators->push_back(engine.update(sample));
+    }
+
+    symbol.chart = std::make_shared<const std::deque<double>>(std::move(chart));
+    symbol.indicators = indicators;
+}
+
+std::shared_ptr<const MarketSnapshot> MarketState::snapshot() {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    // rebuilt at most once per change, however often it is read
+    if (published_->version != version_) {
+        auto reusable = std::find_if(snapshotPool_.begin(), snapshotPool_.end(),
+                                     [](const auto& snapshot) { return snapshot.use_count() == 1; });
+        if (reusable == snapshotPool_.end()) {
+            if (snapshotPool_.size() < SNAPSHOT_POOL_SIZE) {
+                snapshotPool_.push_back(std::make_shared<MarketSnapshot>());
+                reusable = snapshotPool_.end() - 1;
+            }
+        }
+
+        // use_count() is a relaxed read, the last reader's release of the snapshot
+        // must be visible before it is written into again
+        std::atomic_thread_fence(std::memory_order_acquire);
+
+        // every pooled snapshot still in use, fall back to a fresh one
+        auto snapshot = reusable != snapshotPool_.end() ? *reusable : std::make_shared<MarketSnapshot>();
+        catchUp(*snapshot);
+        snapshot->version = version_;
+        snapshot->hot = hotIndices_;
+        published_ = snapshot;
+    }
+    return published_;
+}
+
+// Copies the symbols changed since the snapshot was published last, or all of
+// them when that is further back than the change log or for another watchlist.
+void MarketState::catchUp(MarketSnapshot& snapshot) const {
+    long long from = snapshot.version;
+    if (from < changesSince_ || version_ - from > SNAPSHOT_CHANGE_LOG_SIZE || snapshot.symbols.size() != symbols_.size()) {
+        snapshot.symbols = symbols_;
+        return;
+    }
+
+    for (long long version = from + 1; version <= version_; version += 1) {
+        size_t i = changes_[version % SNAPSHOT_CHANGE_LOG_SIZE];
+        // a symbol traded many times since is copied once
+        if (snapshot.symbols[i].version != symbols_[i].version) {
+            snapshot.symbols[i] = symbols_[i];
+        }
+    }
+}
+
+std::vector<std::string> MarketState::historyLoads(size_t limit, size_t window,
+                                                   const std::function<bool(const SymbolSnapshot&)>& stale) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    std::vector<std::string> loads;
+    auto add = [&loads, limit](const SymbolSnapshot& symbol) {
+        if (loads.size() < limit && std::find(loads.begin(), loads.end(), symbol.apiName) == loads.end()) {
+            loads.push_back(symbol.apiName);
+        }
+    };
+
+    for (const auto& apiSymbol : hot_) {
+        const SymbolSnapshot* symbol = find(apiSymbol);
+        if (symbol != nullptr && (!symbol->historyLoaded || stale(*symbol))) add(*symbol);
+    }
+
+    // a symbol stays queued until its chart is set, a failed load is tried again next call
+    size_t queued = 0;
+    while (queued < historyQueue_.size() && loads.size() < limit) {
+        const SymbolSnapshot& symbol = symbols_[historyQueue_[queued]];
+        if (symbol.historyLoaded) {
+            historyQueue_.erase(historyQueue_.begin() + queued);
+            continue;
+        }
+        add(symbol);
+        queued += 1;
+    }
+
+    // rollup charts age and timeframes change, loaded charts are checked a window at a time
+    for (size_t i = 0; i < window && i < symbols_.size() && loads.size() < limit; i += 1) {
+        historyCursor_ = (historyCursor_ + 1) % symbols_.size();
+        const SymbolSnapshot& symbol = symbols_[historyCursor_];
+        if (symbol.historyLoaded && stale(symbol)) add(symbol);
+    }
+    return loads;
+}
+
+std::vector<std::string> MarketState::staleSymbols(long long now, int staleTime) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    std::vector<std::string> stale;
+    for (const auto& symbol : symbols_) {
+        if (now > symbol.lastTradeTime + staleTime) {
+            stale.push_back(symbol.apiName);
+        }
+    }
+    return stale;
+}
+
+SymbolSnapshot* MarketState::find(const std::string& apiSymbol) {
+    auto it = index_.find(apiSymbol);
+    if (it == index_.end()) return nullptr;
+    return &symbols_[it->second];
+}
+
+void MarketState::touch(SymbolSnapshot& symbol) {
+    version_ += 1;
+    symbol.version = version_;
+    changes_[version_ % SNAPSHOT_CHANGE_LOG_SIZE] = &symbol - symbols_.data();
+}
+
+// After the watchlist or every chart was replaced.
+void MarketState::queueHistoryLoads() {
+    historyQueue_.clear();
+    for (size_t i = 0; i < symbols_.size(); i += 1) {
+        if (!symbols_[i].historyLoaded) historyQueue_.push_back(i);
+    }
+}
+
+bool MarketState::isHot(const std::string& apiSymbol) const {
+    return hot_.empty() || std::find(hot_.begin(), hot_.end(), apiSymbol) != hot_.end();
+}
@@ -0,0 +1,120 @@
+#ifndef MARKET_STATE_HPP
+#define MARKET_STATE_HPP
+
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "Core/GlobalParams.hpp"
+#include "Core/Market/Indicators.hpp"
+
+// Everything the renderer needs to draw one symbol. Published copies are
+// never modified, so the render thread can read them without locking.
+struct SymbolSnapshot {
+    std::string name;
+    std::string apiName;
+    std::string logo;
+    std::string logoPath;                  // resolved once, the renderer draws it every frame
+
+    double price = MISSING_PRICE;          // latest trade since the last clear
+    double lastStoredPrice = ZERO_PRICE;   // fallback when no trade arrived yet
+    double referencePrice = ZERO_PRICE;    // price closest to midnight, base of the daily gain
+
+    // one sample per PRICE_TIME_INTERVAL, or the downsampled rollups of a longer
+    // timeframe, shared between snapshots until it changes
+    std::shared_ptr<const std::deque<double>> chart;
+    std::shared_ptr<const std::deque<IndicatorValues>> indicators; // one entry per chart sample
+    bool historyLoaded = false;
+    bool liveChart = true;                 // live samples are appended, rollup charts are reloaded
+    long long historyLoadedAt = 0;
+
+    long long lastTradeTime = 0;           // not versioned, read through staleSymbols()
+
+    bool hot = true;                       // on screen or next up, published on every trade
+
+    long long version = 0;                 // bumped on every change of this symbol
+};
+
+struct MarketSnapshot {
+    long long version = 0;
+    std::vector<SymbolSnapshot> symbols;
+    std::vector<size_t> hot;               // indices of the hot symbols, empty while every symbol is hot
+};
+
+// Shared price and chart state. Ingest and storage threads write into it,
+// the render thread only ever sees immutable snapshots.
+constexpr size_t SNAPSHOT_POOL_SIZE = 6;
+constexpr long long SNAPSHOT_CHANGE_LOG_SIZE = 1024; // changes a pooled snapshot catches up on instead of a full copy
+
+class MarketState {
+public:
+    MarketState(int chartLength);
+
+    void setSymbols(const std::vector<std::string>& subs,
+                    const std::vector<std::string>& apiSubs,
+                    const std::vector<std::string>& logoSubs);
+    void updatePrice(const std::string& apiSymbol, double price, long long tradeTime);
+    void setHotSymbols(const std::vector<std::string>& apiSymbols);
+    void flushPrices();
+    void setHistory(const std::string& apiSymbol, std::deque<double> chart,
+                    double lastStoredPrice, double referencePrice, bool liveChart = true);
+    void restoreHistory(const std::string& apiSymbol, std::deque<double> chart,
+                        double lastStoredPrice, double referencePrice);
+    void appendSample(const std::string& apiSymbol, double price);
+    void clearHistory();
+    void clear();
+
+    std::shared_ptr<const MarketSnapshot> snapshot();
+    // Charts to load, at most limit: the hot symbols first, then the queue of the ones never
+    // loaded, then charts the caller finds stale in a window of the watchlist that moves on
+    // with every call. A call costs the limit and the window, however long the watchlist.
+    std::vector<std::string> historyLoads(size_t limit, size_t window,
+                                          const std::function<bool(const SymbolSnapshot&)>& stale);
+    std::vector<std::string> staleSymbols(long long now, int staleTime);
+
+private:
+    SymbolSnapshot* find(const std::string& apiSymbol);
+    void touch(SymbolSnapshot& symbol);
+    void catchUp(MarketSnapshot& snapshot) const;
+    void queueHistoryLoads();
+    void updateHot(SymbolSnapshot& symbol);
+    void setChart(SymbolSnapshot& symbol, std::deque<double> chart);
+    bool isHot(const std::string& apiSymbol) const;
+
+    int chartLength_;
+
+    std::vector<SymbolSnapshot> symbols_;
+    std::unordered_map<std::string, size_t> index_;
+    std::unordered_map<std::string, IndicatorEngine> indicatorEngines_; // by api symbol
+
+    // Prices of symbols off the hot tier wait here until the next sample boundary, so
+    // their trades neither bump the version nor rebuild the snapshot. Empty hot set: all hot.
+    // Pending prices are indexed like symbols_, MISSING_PRICE when nothing is waiting.
+    std::vector<std::string> hot_;
+    std::vector<std::string> previousHot_;   // reused by every switch, only symbols entering or leaving are updated
+    std::vector<size_t> hotIndices_;
+    std::vector<double> pendingPrices_;
+    long long version_ = 0;
+    std::shared_ptr<const MarketSnapshot> published_;
+
+    // Snapshots nobody holds anymore are rebuilt in place, copying into their
+    // vectors and strings reuses the capacity of the previous publication.
+    std::vector<std::shared_ptr<MarketSnapshot>> snapshotPool_;
+
+    // Index of the symbol changed by every version after changesSince_, the last
+    // SNAPSHOT_CHANGE_LOG_SIZE of them. A pooled snapshot copies only the symbols
+    // changed since it was published, the hot tier's trades cost the hot symbols.
+    std::vector<size_t> changes_;
+    long long changesSince_ = 0;
+
+    // never loaded symbols by index, oldest first, and the window over the loaded ones
+    std::deque<size_t> historyQueue_;
+    size_t historyCursor_ = 0;
+
+    std::mutex mutex_;
+};
+
+#endif // MARKET_STATE_HPP
@@ -0,0 +1,102 @@
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include "SimulationScript.hpp"
+
+bool SimulationScript::load(const std::string& path) {
+    std::ifstream file(path);
+    if (!file) {
+        std::cerr << "Simulation script " << path << " could not be opened" << std::endl;
+        return false;
+    }
+
+    trades_.clear();
+    std::string line;
+    int lineNumber = 0;
+    while (std::getline(file, line)) {
+        lineNumber += 1;
+        if (line.empty() || line[0] == '#') continue;
+
+        std::istringstream fields(line);
+        std::string time, apiSymbol, price;
+        if (!std::getline(fields, time, ',') || !std::getline(fields, apiSymbol, ',') || !std::getline(fields, price)) {
+            std::cerr << "Skipping line " << lineNumber << " of " << path << ": expected <milliseconds>,<symbol>,<price>" << std::endl;
+            continue;
+        }
+        try {
+            trades_.push_back(SimulatedTrade{std::stoll(time), apiSymbol, std::stod(price)});
+        } catch (const std::exception& e) {
+            std::cerr << "Skipping line " << lineNumber << " of " << path << ": " << e.what() << std::endl;
+        }
+    }
+
+    if (trades_.empty()) {
+        std::cerr << "Simulation script " << path << " has no trades" << std::endl;
+        return false;
+    }
+    index();
+    std::cout << "Loaded " << trades_.size() << " simulated trades from " << path << std::endl;
+    return true;
+}
+
+void SimulationScript::generate(const std::vector<std::string>& apiSymbols, long long start, int seconds, unsigned seed) {
+    std::mt19937 random(seed);
+    std::uniform_int_distribution<int> offset(0, 999);
+    std::normal_distribution<double> step(0.0, 0.0005);
+
+    trades_.clear();
+    trades_.reserve(static_cast<size_t>(apiSymbols.size()) * seconds * SIMULATION_TRADES_PER_SECOND);
+    std::vector<double> prices(apiSymbols.size());
+    for (size_t i = 0; i < prices.size(); i += 1) {
+        prices[i] = 50.0 + 10.0 * i;
+    }
+
+    for (int second = 0; second < seconds; second += 1) {
+        for (size_t i = 0; i < apiSymbols.size(); i += 1) {
+            for (int trade = 0; trade < SIMULATION_TRADES_PER_SECOND; trade += 1) {
+                // rounded to cents like a quote, the stored bars compare exactly
+                prices[i] = std::max(0.01, std::round(prices[i] * (1.0 + step(random)) * 100) / 100);
+                trades_.push_back(SimulatedTrade{start + second * 1000LL + offset(random), apiSymbols[i], prices[i]});
+            }
+        }
+    }
+    index();
+    std::cout << "Generated " << trades_.size() << " simulated trades for " << apiSymbols.size() << " symbols" << std::endl;
+}
+
+// Trades are replayed in time order, the lookups of the check need them per symbol.
+void SimulationScript::index() {
+    std::stable_sort(trades_.begin(), trades_.end(),
+                     [](const SimulatedTrade& a, const SimulatedTrade& b) { return a.time < b.time; });
+
+    bySymbol_.clear();
+    for (const auto& trade : trades_) {
+        bySymbol_[trade.apiSymbol].emplace_back(trade.time, trade.price);
+    }
+}
+
+const std::vector<SimulatedTrade>& SimulationScript::trades() const {
+    return trades_;
+}
+
+long long SimulationScript::start() const {
+    return trades_.empty() ? 0 : trades_.front().time;
+}
+
+long long SimulationScript::end() const {
+    return trades_.empty() ? 0 : trades_.back().time;
+}
+
+double SimulationScript::priceBefore(const std::string& apiSymbol, long long time) const {
+    auto symbol = bySymbol_.find(apiSymbol);
+    if (symbol == bySymbol_.end()) return MISSING_PRICE;
+
+    const auto& trades = symbol->second;
+    auto next = std::lower_bound(trades.begin(), trades.end(), time,
+                                 [](const std::pair<long long, double>& trade, long long t) { return trade.first < t; });
+    if (next == trades.begin()) return MISSING_PRICE;
+    return std::prev(next)->second;
+}
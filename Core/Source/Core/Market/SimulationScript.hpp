@@ -0,0 +1,43 @@
+#ifndef SIMULATION_SCRIPT_HPP
+#define SIMULATION_SCRIPT_HPP
+
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "Core/GlobalParams.hpp"
+
+#define SIMULATION_DEFAULT_START 1710250200000LL // Tuesday 2024-03-12 09:30 New York, in milliseconds
+#define SIMULATION_DEFAULT_LENGTH 23400 // in seconds, one regular session
+#define SIMULATION_TRADES_PER_SECOND 5 // per symbol of a generated day
+#define SIMULATION_WARM_UP 300 // in simulated seconds before the allocation audit is armed
+
+struct SimulatedTrade {
+    long long time;            // in milliseconds since epoch
+    std::string apiSymbol;
+    double price;
+};
+
+// A day of trades for the simulation driver, either read from a
+// `<milliseconds>,<api symbol>,<price>` file or generated as a seeded
+// random walk, so that two runs of the same script store the same bars.
+class SimulationScript {
+public:
+    bool load(const std::string& path);
+    void generate(const std::vector<std::string>& apiSymbols, long long start, int seconds, unsigned seed);
+
+    const std::vector<SimulatedTrade>& trades() const;
+    long long start() const;       // in milliseconds
+    long long end() const;
+
+    // Last traded price of the symbol before the given time in milliseconds, MISSING_PRICE before its first trade.
+    double priceBefore(const std::string& apiSymbol, long long time) const;
+
+private:
+    void index();
+
+    std::vector<SimulatedTrade> trades_;
+    std::unordered_map<std::string, std::vector<std::pair<long long, double>>> bySymbol_;
+};
+
+#endif // SIMULATION_SCRIPT_HPP
@@ -0,0 +1,26 @@
+#include <iostream>
+#include <vector>
+#include "Timeframe.hpp"
+#include "Core/Database/DataStorage.hpp"
+#include "Core/GlobalParams.hpp"
+
+namespace {
+    // Long ranges read precomputed rollups, a month is 720 hourly points rather than 43200 raw ones.
+    const std::vector<Timeframe> TIMEFRAMES = {
+        {"1h", 60 * 60, PRICE_TIME_INTERVAL, ""},
+        {"1d", 24 * 60 * 60, 5 * 60, DB_ROLLUP_5M_TABLE},
+        {"1w", 7 * 24 * 60 * 60, 60 * 60, DB_ROLLUP_1H_TABLE},
+        {"1m", 30 * 24 * 60 * 60, 60 * 60, DB_ROLLUP_1H_TABLE},
+        {"1y", 365 * 24 * 60 * 60, 24 * 60 * 60, DB_ROLLUP_1D_TABLE},
+    };
+}
+
+const Timeframe& findTimeframe(const std::string& name) {
+    for (const auto& timeframe : TIMEFRAMES) {
+        if (timeframe.name == name) {
+            return timeframe;
+        }
+    }
+    std::cerr << "Unknown chart timeframe: " << name << ", using " << TIMEFRAMES.front().name << std::endl;
+    return TIMEFRAMES.front();
+}
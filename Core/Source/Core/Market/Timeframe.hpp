@@ -0,0 +1,16 @@
+#ifndef TIMEFRAME_HPP
+#define TIMEFRAME_HPP
+
+#include <string>
+
+// Time range covered by a chart and the table its points come from.
+struct Timeframe {
+    std::string name;
+    int span;           // in seconds
+    int bucket;         // in seconds
+    std::string table;  // empty for the raw per-minute history
+};
+
+const Timeframe& findTimeframe(const std::string& name);
+
+#endif // TIMEFRAME_HPP
@@ -0,0 +1,130 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include "TradingCalendar.hpp"
+#include "Core/Config.hpp"
+#include "Core/GlobalParams.hpp"
+
+using namespace std::chrono;
+
+namespace {
+    const std::vector<std::string_view> FOREX_EXCHANGES = {"OANDA", "FXCM", "FXPRO", "FOREX.COM", "ICMTRADER", "PEPPERSTONE"};
+
+    const int EQUITY_OPEN_MINUTE = 4 * 60;
+    const int EQUITY_CLOSE_MINUTE = 20 * 60;
+    const int FOREX_ROLL_MINUTE = 17 * 60;
+
+    // US daylight saving time, second Sunday of March to first Sunday of November at 2:00 local time
+    long long newYorkTime(long long now) {
+        year y = year_month_day{floor<days>(sys_seconds{seconds{now}})}.year();
+        auto dstStart = sys_days{y / March / Sunday[2]} + hours{2 + 5};
+        auto dstEnd = sys_days{y / November / Sunday[1]} + hours{2 + 4};
+        bool dst = sys_seconds{seconds{now}} >= dstStart && sys_seconds{seconds{now}} < dstEnd;
+        return now - (dst ? 4 : 5) * 3600;
+    }
+
+    std::string_view stripProvider(std::string_view apiSymbol) {
+        size_t separator = apiSymbol.find(PROVIDER_SEPARATOR);
+        return separator == std::string_view::npos ? apiSymbol : apiSymbol.substr(separator + PROVIDER_SEPARATOR.size());
+    }
+
+    bool parseHours(const std::string& name, MarketHours& hours) {
+        if (name == "24/7" || name == "always") {
+            hours = MarketHours::Always;
+        } else if (name == "forex") {
+            hours = MarketHours::Forex;
+        } else if (name == "us") {
+            hours = MarketHours::UsEquity;
+        } else {
+            return false;
+        }
+        return true;
+    }
+}
+
+TradingCalendar* TradingCalendar::instance_ = nullptr;
+
+// singleton
+TradingCalendar* TradingCalendar::getInstance() {
+   if (instance_ == nullptr) {
+      instance_ = new TradingCalendar();
+   }
+   return instance_;
+}
+
+TradingCalendar::TradingCalendar() {
+    Config* config = Config::getInstance(CONFIG_FILE);
+
+    for (const auto& entry : config->getMarketHours()) {
+        size_t separator = entry.rfind('=');
+        MarketHours hours;
+        if (separator == std::string::npos || !parseHours(entry.substr(separator + 1), hours)) {
+            std::cerr << "Ignoring market hours entry, expected <symbol or exchange>=<24/7|forex|us>: " << entry << std::endl;
+            continue;
+        }
+        overrides_.emplace_back(entry.substr(0, separator), hours);
+    }
+
+    for (const auto& holiday : config->getMarketHolidays()) {
+        int y = 0;
+        unsigned m = 0, d = 0;
+        year_month_day date{year{0}, month{0}, day{0}};
+        if (std::sscanf(holiday.c_str(), "%d-%u-%u", &y, &m, &d) == 3) {
+            date = year{y} / month{m} / day{d};
+        }
+        if (!date.ok()) {
+            std::cerr << "Ignoring market holiday, expected YYYY-MM-DD: " << holiday << std::endl;
+            continue;
+        }
+        holidays_.push_back(sys_days{date}.time_since_epoch().count());
+    }
+    std::sort(holidays_.begin(), holidays_.end());
+}
+
+MarketHours TradingCalendar::hoursOf(std::string_view apiSymbol) const {
+    std::string_view symbol = stripProvider(apiSymbol);
+    size_t colon = symbol.find(':');
+    std::string_view exchange = colon == std::string_view::npos ? std::string_view() : symbol.substr(0, colon);
+
+    for (const auto& [name, hours] : overrides_) {
+        if (name == symbol || name == apiSymbol || (!exchange.empty() && name == exchange)) {
+            return hours;
+        }
+    }
+
+    if (exchange.empty()) return MarketHours::UsEquity;
+    if (std::find(FOREX_EXCHANGES.begin(), FOREX_EXCHANGES.end(), exchange) != FOREX_EXCHANGES.end()) {
+        return MarketHours::Forex;
+    }
+    // crypto exchanges and any other venue keep the full rate
+    return MarketHours::Always;
+}
+
+bool TradingCalendar::isOpen(std::string_view apiSymbol, long long now) const {
+    return isOpen(hoursOf(apiSymbol), now);
+}
+
+// Symbols of the same hours open and close together.
+bool TradingCalendar::isOpen(MarketHours hours, long long now) const {
+    if (hours == MarketHours::Always) return true;
+
+    long long local = newYorkTime(now);
+    auto date = floor<days>(sys_seconds{seconds{local}});
+    unsigned dayOfWeek = weekday{date}.c_encoding();   // 0 is Sunday
+    int minute = (local - sys_seconds{date}.time_since_epoch().count()) / 60;
+
+    if (hours == MarketHours::Forex) {
+        if (dayOfWeek == 6) return false;
+        if (dayOfWeek == 5) return minute < FOREX_ROLL_MINUTE;
+        if (dayOfWeek == 0) return minute >= FOREX_ROLL_MINUTE;
+        return true;
+    }
+
+    if (dayOfWeek == 0 || dayOfWeek == 6 || isHoliday(date.time_since_epoch().count())) return false;
+    return minute >= EQUITY_OPEN_MINUTE && minute < EQUITY_CLOSE_MINUTE;
+}
+
+bool TradingCalendar::isHoliday(int day) const {
+    return std::binary_search(holidays_.begin(), holidays_.end(), day);
+}
@@ -0,0 +1,48 @@
+#ifndef TRADING_CALENDAR_HPP
+#define TRADING_CALENDAR_HPP
+
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+constexpr int LOW_ACTIVITY_FPS = 2;
+
+enum class MarketHours {
+    Always,     // crypto and anything unknown
+    Forex,      // Sunday 17:00 to Friday 17:00 New York time
+    UsEquity,   // weekdays 04:00 to 20:00 New York time, extended hours included, holidays excluded
+};
+
+// Decides per api symbol whether its market trades right now. Symbols
+// qualified with an exchange, e.g. BINANCE:BTCUSDT or OANDA:EUR_USD, follow
+// their exchange, plain tickers are US equities. Market_Hours overrides
+// symbols or exchanges as <symbol or exchange>=<24/7|forex|us>, and
+// Market_Holidays lists the US exchange holidays as YYYY-MM-DD.
+//
+// Closed symbols drop to a low-activity state: their feeds are only required
+// to stay connected, they are not resubscribed or stored, and the display
+// slows down to LOW_ACTIVITY_FPS while one of them is on screen.
+class TradingCalendar {
+
+public:
+    static TradingCalendar* getInstance();
+
+    // Allocation free, called from the render thread.
+    bool isOpen(std::string_view apiSymbol, long long now) const;
+    bool isOpen(MarketHours hours, long long now) const;
+    MarketHours hoursOf(std::string_view apiSymbol) const;
+
+private:
+    static TradingCalendar* instance_;   // The one, single instance
+    TradingCalendar(); // private constructor
+    TradingCalendar(const TradingCalendar&);
+    TradingCalendar& operator=(const TradingCalendar&);
+
+    bool isHoliday(int day) const;
+
+    std::vector<std::pair<std::string, MarketHours>> overrides_;   // by api symbol or exchange
+    std::vector<int> holidays_;                                    // New York dates as days since epoch, sorted
+};
+
+#endif // TRADING_CALENDAR_HPP
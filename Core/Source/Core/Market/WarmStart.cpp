@@ -0,0 +1,223 @@
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cstdint>
+#include <cstring>
+#include <ctime>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <unordered_set>
+#include "WarmStart.hpp"
+
+namespace fs = std::filesystem;
+
+namespace {
+    const char WARM_START_MAGIC[8] = {'T', 'I', 'C', 'K', 'W', 'S', '0', '1'};
+
+    struct Header {
+        char magic[8];
+        uint32_t symbolCount;
+        uint32_t spriteCount;
+        int64_t savedAt;
+        int32_t switchTime;
+        int32_t reserved;
+    };
+
+    class Writer {
+    public:
+        template<typename T>
+        void put(const T& value) {
+            const char* bytes = reinterpret_cast<const char*>(&value);
+            buffer_.insert(buffer_.end(), bytes, bytes + sizeof(T));
+        }
+
+        void putString(const std::string& value) {
+            put<uint16_t>(value.size());
+            buffer_.insert(buffer_.end(), value.begin(), value.end());
+        }
+
+        void putBytes(const void* data, size_t size) {
+            const char* bytes = static_cast<const char*>(data);
+            buffer_.insert(buffer_.end(), bytes, bytes + size);
+        }
+
+        const std::vector<char>& buffer() const { return buffer_; }
+
+    private:
+        std::vector<char> buffer_;
+    };
+
+    // bounds checked cursor over the mapped file
+    class Reader {
+    public:
+        Reader(const char* data, size_t size) : data_(data), size_(size) {}
+
+        template<typename T>
+        bool get(T& value) {
+            if (offset_ + sizeof(T) > size_) return false;
+            std::memcpy(&value, data_ + offset_, sizeof(T));
+            offset_ += sizeof(T);
+            return true;
+        }
+
+        bool getString(std::string& value) {
+            uint16_t length;
+            if (!get(length) || offset_ + length > size_) return false;
+            value.assign(data_ + offset_, length);
+            offset_ += length;
+            return true;
+        }
+
+        bool getBytes(void* data, size_t size) {
+            if (offset_ + size > size_) return false;
+            std::memcpy(data, data_ + offset_, size);
+            offset_ += size;
+            return true;
+        }
+
+    private:
+        const char* data_;
+        size_t size_;
+        size_t offset_ = 0;
+    };
+}
+
+bool WarmStart::save(const std::string& fileName, const MarketSnapshot& snapshot, int switchTime) {
+    std::vector<std::pair<std::string, std::shared_ptr<const Sprite>>> sprites;
+    std::unordered_set<std::string> seenLogos;
+    for (const auto& symbol : snapshot.symbols) {
+        std::string logoPath = LOGO_DIR + "/" + symbol.logo + LOGO_EXT;
+        if (symbol.logo.empty() || !seenLogos.insert(logoPath).second) continue;
+
+        auto sprite = LogoCache::getInstance()->get(logoPath);
+        if (sprite) {
+            sprites.emplace_back(logoPath, sprite);
+        }
+    }
+
+    Writer writer;
+    Header header{};
+    std::memcpy(header.magic, WARM_START_MAGIC, sizeof(header.magic));
+    header.symbolCount = snapshot.symbols.size();
+    header.spriteCount = sprites.size();
+    header.savedAt = time(nullptr);
+    header.switchTime = switchTime;
+    writer.put(header);
+
+    for (const auto& symbol : snapshot.symbols) {
+        writer.putString(symbol.name);
+        writer.putString(symbol.apiName);
+        writer.putString(symbol.logo);
+
+        // the last trade becomes the stored fallback, it is not live after a restart
+        double lastPrice = symbol.price != MISSING_PRICE ? symbol.price : symbol.lastStoredPrice;
+        writer.put(lastPrice);
+        writer.put(symbol.referencePrice);
+
+        uint32_t samples = symbol.chart ? symbol.chart->size() : 0;
+        writer.put(samples);
+        for (uint32_t i = 0; i < samples; i += 1) {
+            writer.put((*symbol.chart)[i]);
+        }
+    }
+
+    for (const auto& [path, sprite] : sprites) {
+        writer.putString(path);
+        writer.put<uint16_t>(sprite->width);
+        writer.put<uint16_t>(sprite->height);
+        writer.putBytes(sprite->rgb.data(), sprite->rgb.size());
+    }
+
+    // written next to the snapshot and renamed, a crash never leaves a torn file
+    std::string tmpName = fileName + ".tmp";
+    {
+        std::ofstream file(tmpName, std::ios::binary | std::ios::trunc);
+        file.write(writer.buffer().data(), writer.buffer().size());
+        if (!file) {
+            std::cerr << "Could not write warm start snapshot: " << tmpName << std::endl;
+            return false;
+        }
+    }
+
+    std::error_code error;
+    fs::rename(tmpName, fileName, error);
+    if (error) {
+        std::cerr << "Could not replace warm start snapshot: " << error.message() << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool WarmStart::load(const std::string& fileName, WarmStartState& state) {
+    int fd = open(fileName.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size < static_cast<off_t>(sizeof(Header))) {
+        close(fd);
+        return false;
+    }
+
+    void* mapped = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (mapped == MAP_FAILED) {
+        std::cerr << "Could not map warm start snapshot: " << fileName << std::endl;
+        return false;
+    }
+
+    Reader reader(static_cast<const char*>(mapped), info.st_size);
+    Header header;
+    bool valid = reader.get(header) && std::memcmp(header.magic, WARM_START_MAGIC, sizeof(header.magic)) == 0;
+
+    if (valid) {
+        state.switchTime = header.switchTime;
+        state.symbols.resize(header.symbolCount);
+        for (auto& symbol : state.symbols) {
+            uint32_t samples = 0;
+            valid = reader.getString(symbol.name) && reader.getString(symbol.apiName) && reader.getString(symbol.logo) &&
+                    reader.get(symbol.lastStoredPrice) && reader.get(symbol.referencePrice) && reader.get(samples);
+            if (!valid) break;
+
+            auto chart = std::make_shared<std::deque<double>>(samples);
+            for (auto& sample : *chart) {
+                valid = valid && reader.get(sample);
+            }
+            if (!valid) break;
+            symbol.chart = chart;
+
+            state.subs.push_back(symbol.name);
+            state.apiSubs.push_back(symbol.apiName);
+            state.logoSubs.push_back(symbol.logo);
+        }
+    }
+
+    for (uint32_t i = 0; valid && i < header.spriteCount; i += 1) {
+        std::string path;
+        uint16_t width, height;
+        auto sprite = std::make_shared<Sprite>();
+        valid = reader.getString(path) && reader.get(width) && reader.get(height);
+        if (!valid) break;
+
+        sprite->width = width;
+        sprite->height = height;
+        sprite->rgb.resize(static_cast<size_t>(width) * height * 3);
+        valid = reader.getBytes(sprite->rgb.data(), sprite->rgb.size());
+        if (valid) {
+            state.sprites.emplace_back(path, sprite);
+        }
+    }
+
+    munmap(mapped, info.st_size);
+
+    if (!valid) {
+        std::cerr << "Ignoring corrupt warm start snapshot: " << fileName << std::endl;
+        state = WarmStartState();
+        return false;
+    }
+
+    std::cout << "Loaded warm start snapshot with " << state.symbols.size() << " symbols saved "
+              << time(nullptr) - header.savedAt << "s ago" << std::endl;
+    return true;
+}
@@ -0,0 +1,35 @@
+#ifndef WARM_START_HPP
+#define WARM_START_HPP
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+#include "Core/Images/LogoCache.hpp"
+#include "Core/Market/MarketState.hpp"
+
+// What the panel showed when the snapshot was written.
+struct WarmStartState {
+    std::vector<std::string> subs;
+    std::vector<std::string> apiSubs;
+    std::vector<std::string> logoSubs;
+    int switchTime = 0;
+
+    std::vector<SymbolSnapshot> symbols;
+    std::vector<std::pair<std::string, std::shared_ptr<const Sprite>>> sprites; // by logo path
+};
+
+// Compact binary image of the display state, rewritten periodically and
+// mapped on boot so that the first frame needs neither the controller,
+// the logo downloads nor the database.
+//
+// Layout: header, then per symbol its names, prices and chart samples,
+// then the decoded logo sprites. Everything is native endian, the file is
+// only ever read back on the machine that wrote it.
+class WarmStart {
+public:
+    static bool save(const std::string& fileName, const MarketSnapshot& snapshot, int switchTime);
+    static bool load(const std::string& fileName, WarmStartState& state);
+};
+
+#endif // WARM_START_HPP
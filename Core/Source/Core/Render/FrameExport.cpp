@@ -0,0 +1,105 @@
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <new>
+#include "FrameExport.hpp"
+
+namespace {
+    constexpr size_t CACHE_LINE = 64;
+
+    size_t alignUp(size_t size) {
+        return (size + CACHE_LINE - 1) / CACHE_LINE * CACHE_LINE;
+    }
+}
+
+FrameExport::~FrameExport() {
+    close();
+}
+
+bool FrameExport::open(const std::string& name, int width, int height) {
+    close();
+
+    frameBytes_ = static_cast<size_t>(width) * height * 3;
+    size_t headerSize = alignUp(sizeof(FrameRingHeader));
+    size_t slotSize = alignUp(sizeof(FrameSlot) + frameBytes_);
+    size_t size = headerSize + slotSize * FRAME_RING_SLOTS;
+
+    int fd = shm_open(name.c_str(), O_CREAT | O_RDWR, 0644);
+    if (fd < 0) {
+        std::cerr << "Could not create frame export " << name << ": " << strerror(errno) << std::endl;
+        return false;
+    }
+    if (ftruncate(fd, size) != 0) {
+        std::cerr << "Could not size frame export " << name << ": " << strerror(errno) << std::endl;
+        ::close(fd);
+        shm_unlink(name.c_str());
+        return false;
+    }
+
+    void* memory = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (memory == MAP_FAILED) {
+        std::cerr << "Could not map frame export " << name << ": " << strerror(errno) << std::endl;
+        shm_unlink(name.c_str());
+        return false;
+    }
+
+    name_ = name;
+    memory_ = static_cast<uint8_t*>(memory);
+    size_ = size;
+    frames_ = 0;
+
+    // a ring left behind by an earlier run is reset, its readers start over
+    std::memset(memory_, 0, size_);
+    header_ = new (memory_) FrameRingHeader{FRAME_RING_MAGIC, FRAME_RING_VERSION,
+                                            static_cast<uint32_t>(width), static_cast<uint32_t>(height),
+                                            FRAME_RING_SLOTS, static_cast<uint32_t>(slotSize), {0}};
+    for (uint64_t i = 0; i < FRAME_RING_SLOTS; i += 1) {
+        new (slot(i)) FrameSlot{{0}, 0};
+    }
+
+    std::cout << "Exporting frames to shared memory " << name_ << ", " << FRAME_RING_SLOTS << " slots of "
+              << width << "x" << height << std::endl;
+    return true;
+}
+
+void FrameExport::close() {
+    if (memory_ == nullptr) return;
+
+    munmap(memory_, size_);
+    shm_unlink(name_.c_str());
+    memory_ = nullptr;
+    header_ = nullptr;
+}
+
+bool FrameExport::isOpen() const {
+    return memory_ != nullptr;
+}
+
+void FrameExport::publish(const OffscreenCanvas& frame) {
+    if (memory_ == nullptr) return;
+    if (frame.width() != static_cast<int>(header_->width) || frame.height() != static_cast<int>(header_->height)) return;
+
+    frames_ += 1;
+    FrameSlot* target = slot(frames_);
+
+    // seqlock, readers that saw the odd sequence or read across it drop the frame
+    target->sequence.store(frames_ * 2 - 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    auto now = std::chrono::system_clock::now().time_since_epoch();
+    target->timestamp = std::chrono::duration_cast<std::chrono::microseconds>(now).count();
+    std::memcpy(target->pixels(), frame.pixel(0, 0), frameBytes_);
+
+    target->sequence.store(frames_ * 2, std::memory_order_release);
+    header_->latestFrame.store(frames_, std::memory_order_release);
+}
+
+FrameSlot* FrameExport::slot(uint64_t frame) const {
+    size_t headerSize = alignUp(sizeof(FrameRingHeader));
+    return reinterpret_cast<FrameSlot*>(memory_ + headerSize + (frame % FRAME_RING_SLOTS) * header_->slotSize);
+}
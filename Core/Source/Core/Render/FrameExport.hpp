@@ -0,0 +1,67 @@
+#ifndef FRAME_EXPORT_HPP
+#define FRAME_EXPORT_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include "Core/Render/OffscreenCanvas.hpp"
+
+constexpr uint32_t FRAME_RING_MAGIC = 0x54424652; // "TBFR"
+constexpr uint32_t FRAME_RING_VERSION = 1;
+constexpr uint32_t FRAME_RING_SLOTS = 8;
+
+// Layout of the shared memory object, consumers map it read-only and include
+// this header. Frame n (counting from 1) lives in slot n % slotCount. A slot's
+// sequence is 2n - 1 while frame n is written into it and 2n once it is done,
+// so a reader takes latestFrame, checks that the slot holds 2 * latestFrame,
+// reads the pixels in place and accepts them if the sequence did not change.
+// The writer never waits for readers, a slow reader only loses frames.
+struct FrameRingHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t width;
+    uint32_t height;
+    uint32_t slotCount;
+    uint32_t slotSize;                    // bytes from one slot to the next
+    std::atomic<uint64_t> latestFrame;    // 0 until the first frame
+};
+
+// Followed by the pixels, width * height * 3 bytes of RGB rows from the top.
+struct FrameSlot {
+    std::atomic<uint64_t> sequence;
+    uint64_t timestamp;                   // microseconds since epoch
+
+    const uint8_t* pixels() const { return reinterpret_cast<const uint8_t*>(this + 1); }
+    uint8_t* pixels() { return reinterpret_cast<uint8_t*>(this + 1); }
+};
+
+// Publishes the composed frames of the panel into a POSIX shared memory ring.
+// Publishing costs one copy of the frame on the render thread, readers take
+// no locks and are never waited for.
+class FrameExport {
+public:
+    FrameExport() = default;
+    ~FrameExport();
+
+    bool open(const std::string& name, int width, int height);
+    void close();
+    bool isOpen() const;
+
+    void publish(const OffscreenCanvas& frame);
+
+private:
+    FrameExport(const FrameExport&);
+    FrameExport& operator=(const FrameExport&);
+
+    FrameSlot* slot(uint64_t frame) const;
+
+    std::string name_;
+    uint8_t* memory_ = nullptr;
+    size_t size_ = 0;
+    FrameRingHeader* header_ = nullptr;
+    size_t frameBytes_ = 0;
+    uint64_t frames_ = 0;
+};
+
+#endif // FRAME_EXPORT_HPP
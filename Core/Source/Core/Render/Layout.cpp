@@ -0,0 +1,183 @@
+#include <algorithm>
+#include <cstdio>
+#include <functional>
+#include <iostream>
+#include <string_view>
+#include "Layout.hpp"
+#include "Core/Images/LogoCache.hpp"
+
+namespace {
+    bool parseKind(const std::string& name, WidgetKind& kind) {
+        if (name == "logo") {
+            kind = WidgetKind::Logo;
+        } else if (name == "text") {
+            kind = WidgetKind::Text;
+        } else if (name == "price") {
+            kind = WidgetKind::Price;
+        } else if (name == "gain") {
+            kind = WidgetKind::Gain;
+        } else if (name == "sparkline") {
+            kind = WidgetKind::Sparkline;
+        } else {
+            return false;
+        }
+        return true;
+    }
+
+    uint64_t combine(uint64_t seed, uint64_t value) {
+        return seed ^ (value + 0x9e3779b97f4a7c15ULL + (seed << 6) + (seed >> 2));
+    }
+
+    uint64_t hashOf(const std::string& text) {
+        return std::hash<std::string_view>()(text);
+    }
+
+    uint64_t hashOf(double value) {
+        return std::hash<double>()(value);
+    }
+
+    double displayPrice(const SymbolSnapshot& symbol) {
+        return symbol.price != MISSING_PRICE ? symbol.price : symbol.lastStoredPrice;
+    }
+}
+
+Layout::Layout(const std::vector<std::string>& entries) {
+    for (const auto& entry : entries) {
+        if (!parseWidget(entry, widgets_)) {
+            std::cerr << "Ignoring layout widget, expected <kind>[@<api symbol>]=<x>,<y>,<width>,<height>: " << entry << std::endl;
+        }
+    }
+    for (const auto& widget : widgets_) {
+        if (widget.kind == WidgetKind::GridCell) cells_ += 1;
+    }
+}
+
+bool Layout::parseWidget(const std::string& entry, std::vector<Widget>& widgets) {
+    size_t separator = entry.rfind('=');
+    if (separator == std::string::npos) return false;
+
+    std::string name = entry.substr(0, separator);
+    std::string apiSymbol;
+    size_t at = name.find('@');
+    if (at != std::string::npos) {
+        apiSymbol = name.substr(at + 1);
+        name = name.substr(0, at);
+    }
+
+    WidgetBox box;
+    int columns = 1, rows = 1;
+    int fields = std::sscanf(entry.c_str() + separator + 1, "%d,%d,%d,%d,%dx%d",
+                             &box.x, &box.y, &box.width, &box.height, &columns, &rows);
+    if (fields < 4 || box.width <= 0 || box.height <= 0) return false;
+
+    if (name == "grid") {
+        if (fields != 6 || columns <= 0 || rows <= 0) return false;
+
+        // cells fill the page row by row, every cell is its own widget with its own dirty flag
+        int slot = 0;
+        for (const auto& widget : widgets) {
+            if (widget.kind == WidgetKind::GridCell) slot += 1;
+        }
+        for (int row = 0; row < rows; row += 1) {
+            for (int column = 0; column < columns; column += 1) {
+                Widget cell;
+                cell.kind = WidgetKind::GridCell;
+                cell.box = {box.x + column * box.width / columns, box.y + row * box.height / rows,
+                            box.width / columns, box.height / rows};
+                cell.slot = slot++;
+                widgets.push_back(cell);
+            }
+        }
+        return true;
+    }
+
+    Widget widget;
+    if (fields != 4 || !parseKind(name, widget.kind)) return false;
+    widget.box = box;
+    widget.apiSymbol = apiSymbol;
+    widgets.push_back(widget);
+    return true;
+}
+
+bool Layout::empty() const {
+    return widgets_.empty();
+}
+
+std::vector<Widget>& Layout::widgets() {
+    return widgets_;
+}
+
+void Layout::update(const MarketSnapshot& snapshot, int primaryIndex, int page) {
+    int symbolsCount = snapshot.symbols.size();
+    int pages = cells_ > 0 ? (symbolsCount + cells_ - 1) / cells_ : 1;
+
+    for (auto& widget : widgets_) {
+        widget.symbol = nullptr;
+        if (symbolsCount == 0) {
+            // nothing to show
+        } else if (widget.slot >= 0) {
+            int index = (page % std::max(pages, 1)) * cells_ + widget.slot;
+            if (index < symbolsCount) widget.symbol = &snapshot.symbols[index];
+        } else if (!widget.apiSymbol.empty()) {
+            for (const auto& symbol : snapshot.symbols) {
+                if (symbol.apiName == widget.apiSymbol) {
+                    widget.symbol = &symbol;
+                    break;
+                }
+            }
+        } else if (primaryIndex >= 0 && primaryIndex < symbolsCount) {
+            widget.symbol = &snapshot.symbols[primaryIndex];
+        }
+
+        uint64_t current = fingerprint(widget);
+        if (current != widget.drawn) {
+            widget.drawn = current;
+            widget.dirty = true;
+        }
+    }
+}
+
+// Only what a widget draws goes into its fingerprint, a trade does not redraw a logo.
+uint64_t Layout::fingerprint(const Widget& widget) {
+    if (widget.symbol == nullptr) return 1;
+
+    const SymbolSnapshot& symbol = *widget.symbol;
+    uint64_t seed = hashOf(symbol.apiName);
+    switch (widget.kind) {
+        case WidgetKind::Logo:
+            // a logo downloaded after the first draw is a new sprite in the cache
+            seed = combine(seed, hashOf(symbol.logoPath));
+            return combine(seed, reinterpret_cast<uintptr_t>(LogoCache::getInstance()->get(symbol.logoPath).get()));
+        case WidgetKind::Text:
+            return combine(seed, hashOf(symbol.name));
+        case WidgetKind::Price:
+            return combine(seed, hashOf(displayPrice(symbol)));
+        case WidgetKind::Gain:
+            return combine(combine(seed, hashOf(displayPrice(symbol))), hashOf(symbol.referencePrice));
+        case WidgetKind::Sparkline:
+            // a replaced chart is a new deque, appended samples change its length and last value
+            seed = combine(seed, reinterpret_cast<uintptr_t>(symbol.chart.get()));
+            if (symbol.chart && !symbol.chart->empty()) {
+                seed = combine(combine(seed, symbol.chart->size()), hashOf(symbol.chart->back()));
+            }
+            seed = combine(seed, reinterpret_cast<uintptr_t>(symbol.indicators.get()));
+            return combine(seed, hashOf(symbol.price));
+        case WidgetKind::GridCell:
+            seed = combine(seed, hashOf(symbol.name));
+            return combine(combine(seed, hashOf(displayPrice(symbol))), hashOf(symbol.referencePrice));
+    }
+    return seed;
+}
+
+void Layout::invalidate() {
+    cleared_ = true;
+    for (auto& widget : widgets_) {
+        widget.dirty = true;
+    }
+}
+
+bool Layout::takeCleared() {
+    bool cleared = cleared_;
+    cleared_ = false;
+    return cleared;
+}
@@ -0,0 +1,70 @@
+#ifndef LAYOUT_HPP
+#define LAYOUT_HPP
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "Core/Market/MarketState.hpp"
+
+const std::string LAYOUT_DISPLAY_MODE = "layout";
+
+struct WidgetBox {
+    int x = 0;
+    int y = 0;
+    int width = 0;
+    int height = 0;
+};
+
+enum class WidgetKind {
+    Logo,
+    Text,        // symbol name
+    Price,
+    Gain,
+    Sparkline,   // chart with the configured indicators
+    GridCell,    // name and gain of one symbol of a grid page
+};
+
+// One box of the panel and the data it shows. Widgets without a symbol follow
+// the symbol on screen, grid cells show their slot of the current page.
+struct Widget {
+    WidgetKind kind = WidgetKind::Text;
+    WidgetBox box;
+    std::string apiSymbol;
+    int slot = -1;
+
+    // resolved by Layout::update() for the current frame, nullptr when the slot is empty
+    const SymbolSnapshot* symbol = nullptr;
+    uint64_t drawn = 0;      // fingerprint of the data last drawn
+    bool dirty = true;
+};
+
+// Widgets declared by the Layout option, one entry per widget as
+//   <kind>[@<api symbol>]=<x>,<y>,<width>,<height>
+// with kind one of logo, text, price, gain and sparkline, plus
+//   grid=<x>,<y>,<width>,<height>,<columns>x<rows>
+// which splits its box into cells paging through the watchlist. Every frame
+// only the widgets whose data changed are marked dirty and re-rasterised.
+class Layout {
+public:
+    Layout() = default;
+    Layout(const std::vector<std::string>& entries);
+
+    bool empty() const;
+    std::vector<Widget>& widgets();
+
+    // Resolves every widget's symbol and marks the ones whose data changed.
+    void update(const MarketSnapshot& snapshot, int primaryIndex, int page);
+    // Everything is redrawn on the next frame, after something was painted over the widgets.
+    void invalidate();
+    bool takeCleared();
+
+private:
+    static bool parseWidget(const std::string& entry, std::vector<Widget>& widgets);
+    static uint64_t fingerprint(const Widget& widget);
+
+    std::vector<Widget> widgets_;
+    int cells_ = 0;            // grid cells per page
+    bool cleared_ = true;      // the panel has to be cleared before the next draw
+};
+
+#endif // LAYOUT_HPP
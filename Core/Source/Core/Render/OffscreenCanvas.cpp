@@ -0,0 +1,102 @@
+#include <algorithm>
+#include "OffscreenCanvas.hpp"
+
+OffscreenCanvas::OffscreenCanvas(int width, int height) {
+    resize(width, height);
+}
+
+void OffscreenCanvas::resize(int width, int height) {
+    width_ = width;
+    height_ = height;
+    pixels_.assign(static_cast<size_t>(width) * height * 3, 0);
+}
+
+int OffscreenCanvas::width() const {
+    return width_;
+}
+
+int OffscreenCanvas::height() const {
+    return height_;
+}
+
+void OffscreenCanvas::SetPixel(int x, int y, uint8_t red, uint8_t green, uint8_t blue) {
+    if (x < 0 || y < 0 || x >= width_ || y >= height_) return;
+
+    uint8_t* p = &pixels_[(static_cast<size_t>(y) * width_ + x) * 3];
+    p[0] = red;
+    p[1] = green;
+    p[2] = blue;
+}
+
+void OffscreenCanvas::Clear() {
+    std::fill(pixels_.begin(), pixels_.end(), 0);
+}
+
+void OffscreenCanvas::Fill(uint8_t red, uint8_t green, uint8_t blue) {
+    for (size_t i = 0; i < pixels_.size(); i += 3) {
+        pixels_[i] = red;
+        pixels_[i + 1] = green;
+        pixels_[i + 2] = blue;
+    }
+}
+
+const uint8_t* OffscreenCanvas::pixel(int x, int y) const {
+    return &pixels_[(static_cast<size_t>(y) * width_ + x) * 3];
+}
+
+CanvasView::CanvasView(rgb_matrix::Canvas* parent, int offsetX, int width)
+    : parent_(parent), offsetX_(offsetX), width_(width) {}
+
+int CanvasView::width() const {
+    return width_;
+}
+
+int CanvasView::height() const {
+    return parent_->height();
+}
+
+void CanvasView::SetPixel(int x, int y, uint8_t red, uint8_t green, uint8_t blue) {
+    if (x < 0 || x >= width_) return;
+    parent_->SetPixel(x + offsetX_, y, red, green, blue);
+}
+
+void CanvasView::Clear() {
+    Fill(0, 0, 0);
+}
+
+void CanvasView::Fill(uint8_t red, uint8_t green, uint8_t blue) {
+    for (int y = 0; y < height(); y += 1) {
+        for (int x = 0; x < width_; x += 1) {
+            parent_->SetPixel(x + offsetX_, y, red, green, blue);
+        }
+    }
+}
+
+MirrorCanvas::MirrorCanvas(OffscreenCanvas* shadow) : shadow_(shadow) {}
+
+void MirrorCanvas::setPanel(rgb_matrix::Canvas* panel) {
+    panel_ = panel;
+}
+
+int MirrorCanvas::width() const {
+    return panel_->width();
+}
+
+int MirrorCanvas::height() const {
+    return panel_->height();
+}
+
+void MirrorCanvas::SetPixel(int x, int y, uint8_t red, uint8_t green, uint8_t blue) {
+    panel_->SetPixel(x, y, red, green, blue);
+    shadow_->SetPixel(x, y, red, green, blue);
+}
+
+void MirrorCanvas::Clear() {
+    panel_->Clear();
+    shadow_->Clear();
+}
+
+void MirrorCanvas::Fill(uint8_t red, uint8_t green, uint8_t blue) {
+    panel_->Fill(red, green, blue);
+    shadow_->Fill(red, green, blue);
+}
@@ -0,0 +1,68 @@
+#ifndef OFFSCREEN_CANVAS_HPP
+#define OFFSCREEN_CANVAS_HPP
+
+#include "canvas.h"
+#include <cstdint>
+#include <vector>
+
+// RGB pixel buffer that the rgb_matrix drawing functions can target,
+// so that frames can be composed away from the panel and blitted later.
+class OffscreenCanvas : public rgb_matrix::Canvas {
+public:
+    OffscreenCanvas(int width = 0, int height = 0);
+
+    void resize(int width, int height);
+
+    int width() const override;
+    int height() const override;
+    void SetPixel(int x, int y, uint8_t red, uint8_t green, uint8_t blue) override;
+    void Clear() override;
+    void Fill(uint8_t red, uint8_t green, uint8_t blue) override;
+
+    const uint8_t* pixel(int x, int y) const;
+
+private:
+    int width_;
+    int height_;
+    std::vector<uint8_t> pixels_;
+};
+
+// Window onto a horizontal slice of another canvas. Drawing is translated
+// by offsetX and clipped to the slice, so code written for a single panel
+// can draw into one segment of a wider canvas.
+class CanvasView : public rgb_matrix::Canvas {
+public:
+    CanvasView(rgb_matrix::Canvas* parent, int offsetX, int width);
+
+    int width() const override;
+    int height() const override;
+    void SetPixel(int x, int y, uint8_t red, uint8_t green, uint8_t blue) override;
+    void Clear() override;
+    void Fill(uint8_t red, uint8_t green, uint8_t blue) override;
+
+private:
+    rgb_matrix::Canvas* parent_;
+    int offsetX_;
+    int width_;
+};
+
+// Draws into the panel and keeps a copy of every pixel in a shadow canvas,
+// so the shadow always holds what the panel shows.
+class MirrorCanvas : public rgb_matrix::Canvas {
+public:
+    MirrorCanvas(OffscreenCanvas* shadow);
+
+    void setPanel(rgb_matrix::Canvas* panel);
+
+    int width() const override;
+    int height() const override;
+    void SetPixel(int x, int y, uint8_t red, uint8_t green, uint8_t blue) override;
+    void Clear() override;
+    void Fill(uint8_t red, uint8_t green, uint8_t blue) override;
+
+private:
+    rgb_matrix::Canvas* panel_ = nullptr;
+    OffscreenCanvas* shadow_;
+};
+
+#endif // OFFSCREEN_CANVAS_HPP
@@ -1,13 +1,11 @@
-#include <opencv2/highgui.hpp>
-#include <filesystem>
 #include <algorithm> // for std::min
+#include <cstring>
 #include "Renderer.hpp"
+#include "Core/Images/LogoCache.hpp"
 
 using rgb_matrix::Canvas;
 using rgb_matrix::RGBMatrix;
 using rgb_matrix::FrameCanvas;
-using namespace cv;
-namespace fs = std::filesystem;
 
 Renderer::Renderer() {
     // Initialize the RGB matrix with
@@ -41,14 +39,59 @@ Renderer::Renderer() {
     }
     delete[] argv;  // Free the array of pointers
 
+    // the library starts its refresh thread itself, it is found by comparing the thread lists
+    std::set<pid_t> threadsBefore = ThreadPlacement::processThreads();
     matrix_ = RGBMatrix::CreateFromOptions(matrixOptions_, runtimeOpt);
     if (matrix_ == NULL){
         std::cerr << "Unable to initialize matrix" << std::endl;
         exit(1);
     }
+
+    std::set<pid_t> matrixThreads;
+    for (pid_t thread : ThreadPlacement::processThreads()) {
+        if (threadsBefore.count(thread) == 0) matrixThreads.insert(thread);
+    }
+    ThreadPlacement::getInstance()->apply(MATRIX_THREAD_ROLE, matrixThreads);
+
+    if (!config_->getFrameExport().empty()) {
+        shadow_.resize(matrix_->width(), matrix_->height());
+        frameExport_.open(config_->getFrameExport(), matrix_->width(), matrix_->height());
+    }
+
+    // fonts are parsed once, every frame draws with them
+    loadFont(symbolFont_, SYMBOL_FONT_WIDTH, SYMBOL_FONT_HEIGHT);
+    loadFont(priceFont_, PRICE_FONT_WIDTH, PRICE_FONT_HEIGHT);
+    loadFont(percentageFont_, PERCENTAGE_FONT_WIDTH, PERCENTAGE_FONT_HEIGHT);
+
+    if (config_->getDisplayMode() == LAYOUT_DISPLAY_MODE) {
+        layout_ = Layout(config_->getLayout());
+    }
+
+    for (const auto& indicator : config_->getChartIndicators()) {
+        if (indicator == "sma") {
+            showSma_ = true;
+        } else if (indicator == "ema") {
+            showEma_ = true;
+        } else if (indicator == "bollinger") {
+            showBollinger_ = true;
+        } else {
+            std::cerr << "Unknown chart indicator: " << indicator << std::endl;
+        }
+    }
+}
+
+void Renderer::loadFont(rgb_matrix::Font& font, int width, int height) {
+    std::string bdfFontFile = "fonts/"+ std::to_string(width) + "x"+std::to_string(height) +".bdf";
+
+    //Load font. This needs to be a filename with a bdf bitmap font.
+    if (!font.LoadFont(bdfFontFile.c_str())) {
+        fprintf(stderr, "Couldn't load font '%s'\n", bdfFontFile.c_str());
+        exit(1);
+    }
 }
 
 Renderer::~Renderer() {
+    frameExport_.close();
     std::cout << "Clearing matrix..." << std::endl;
     matrix_->Clear();
     delete matrix_;
@@ -56,293 +99,459 @@ Renderer::~Renderer() {
     std::cout << "Cleared matrix." << std::endl;
 }
 
-void Renderer::updateChart(std::string symbol, double lastPrice, bool savePrice, bool toRender) {
-    if (pastCharts_[symbol].empty()) {
-        pastCharts_[symbol] = dataStorage_->getPriceHistory(symbol, MATRIX_WIDTH);
-        // if we refetch past chart, do not save the last price, because it will be in past chart
-        if (lastPrice != MISSING_PRICE) {
-            savePrice = false;
-        } 
-    }
-    
-    int offsetX = logoRendered_ ? config_->getLogoSize() + LOGO_CHART_GAP : 0;
-    int offsetY = MATRIX_WIDTH - config_->getChartHeight();
-
-    // print symbol
-    std::cout << "symbol: " << symbol << std::endl;
+void Renderer::renderChart(rgb_matrix::Canvas* canvas, const SymbolSnapshot& symbol, bool logoRendered) {
+    int offsetX = logoRendered ? config_->getLogoSize() + LOGO_CHART_GAP : 0;
+    int height = config_->getChartHeight() + 1;
 
-    std::cout << "past chart: " << std::endl;
-    for (int i = offsetX; i < MATRIX_WIDTH; i += 1) {
-        std::cout << pastCharts_[symbol][i] << " "; 
+    // clear the gap between the chart and the logo
+    if (logoRendered && symbol.chart) {
+        for (int y = height - 1; y >= 0; y -= 1) {
+            canvas->SetPixel(offsetX - 1, canvas->height() - y - 1, 0, 0, 0);
+        }
     }
-    std::cout << std::endl;
 
-    // print last price
-    std::cout << "last price: " << lastPrice << std::endl; 
-
-    pastCharts_[symbol].push_back(lastPrice);
+    renderChart(canvas, symbol, WidgetBox{offsetX, canvas->height() - height, MATRIX_WIDTH - offsetX, height});
+}
 
-    // make sure chart_ has <width> number of columns
-    if (pastCharts_[symbol].size() > MATRIX_WIDTH) {
-        pastCharts_[symbol].pop_front();
+// The chart fills the box from the bottom, one column per sample and the live price rightmost.
+void Renderer::renderChart(rgb_matrix::Canvas* canvas, const SymbolSnapshot& symbol, const WidgetBox& box) {
+    if (!symbol.chart || box.width <= 1 || box.height <= 0) return;
+
+    // stored samples plus the live price as the rightmost column, in a fixed per-call buffer
+    int width = std::min(box.width, MATRIX_WIDTH);
+    int chartHeight = box.height - 1;
+    int offsetX = box.x;
+    int bottom = box.y + box.height - 1;
+    std::array<double, MATRIX_WIDTH> chart;
+    chart.fill(MISSING_PRICE);
+    chart[width - 1] = symbol.price;
+    int samples = std::min<int>(symbol.chart->size(), width - 1);
+    std::copy(symbol.chart->end() - samples, symbol.chart->end(), chart.begin() + width - 1 - samples);
+
+    // columns before the first value are skipped, the chart starts at offsetX
+    int firstColumn = 0;
+    while (firstColumn < width && chart[firstColumn] == MISSING_PRICE) {
+        firstColumn += 1;
     }
-
-    bool hasValue = false;
-    for (int i = offsetX; i < MATRIX_WIDTH; i += 1) {
-        if (pastCharts_[symbol][i] != MISSING_PRICE) {
-            hasValue = true;
-            break;
-        }
+    if (firstColumn == width) {
+        return;
     }
 
-    if (!hasValue) {
-        return;
+    int renderedChartWidth = width - firstColumn;
+    std::array<double, MATRIX_WIDTH> renderedChart;
+    std::copy(chart.begin() + firstColumn, chart.end(), renderedChart.begin());
+
+    // min and max value in the chart
+    double minValue = std::numeric_limits<double>::max(); // Initialize with a large value
+    double maxValue = MISSING_PRICE;
+    for (int i = 0; i < renderedChartWidth; i += 1) {
+        if (renderedChart[i] == MISSING_PRICE) continue;
+        minValue = std::min(minValue, renderedChart[i]);
+        maxValue = std::max(maxValue, renderedChart[i]);
     }
 
-    if (toRender) {
-        std::vector<double> renderedChart;
-        for (int i = offsetX; i < MATRIX_WIDTH; i += 1) {
-            renderedChart.push_back(pastCharts_[symbol][i]);
+    // normalize the chart
+    for(int i = 0; i < renderedChartWidth; i += 1){
+        if (renderedChart[i] == MISSING_PRICE){
+            continue;
         }
+        else if (minValue != maxValue){
+            renderedChart[i] = ((renderedChart[i] - minValue) / (double)(maxValue - minValue)) * chartHeight;
+        }
+        else {
+            renderedChart[i] = 0;
+        } 
+    }
 
-        // min value in the chart
-        double minValue = std::numeric_limits<double>::max(); // Initialize with a large value
-        for (double num : renderedChart) if (num != MISSING_PRICE && num < minValue) minValue = num;
-
-        // max value in the chart
-        double maxValue = *std::max_element(renderedChart.begin(), renderedChart.end());
+    for(int y = chartHeight; y >= 0; y -= 1){
+        for(int x = 0; x < renderedChartWidth; x += 1){
+            canvas->SetPixel(x + offsetX, bottom - y, 0, 0, 0);
+            // skip missing timepoints
+            if (renderedChart[x] == MISSING_PRICE) continue;
 
-        // normalize the chart
-        for(int i = 0; i < renderedChart.size(); i += 1){
-            if (renderedChart[i] == MISSING_PRICE){
-                continue;
-            }
-            else if (minValue != maxValue){
-                renderedChart[i] = ((renderedChart[i] - minValue) / (double)(maxValue - minValue)) * config_->getChartHeight();
+            if (y == (int)renderedChart[x]){
+                canvas->SetPixel(x + offsetX, bottom - y, chartTopRGB[0], chartTopRGB[1], chartTopRGB[2]);
             }
-            else {
-                renderedChart[i] = 0;
-            } 
+            else if (y == 0 || y < renderedChart[x]){
+                if ((x > 0 && y > renderedChart[x - 1]) || 
+                    (x < renderedChartWidth-1 && y > renderedChart[x + 1])){
+                    canvas->SetPixel(x + offsetX, bottom - y, chartTopRGB[0], chartTopRGB[1], chartTopRGB[2]);
+                }
+                else {
+                    canvas->SetPixel(x + offsetX, bottom - y, chartBaseRGB[0], chartBaseRGB[1], chartBaseRGB[2]);
+                }
+            }          
         }
+    }
 
-        // clear the gap between the chart and the logo
-        if (logoRendered_) {
-            for(int y = config_->getChartHeight(); y >= 0; y -= 1){
-                matrix_->SetPixel(offsetX-1, matrix_->height() - y - 1, 0, 0, 0);
-            } 
-        }
+    if (!symbol.indicators || !(showSma_ || showEma_ || showBollinger_)) return;
+
+    // indicators share the chart's columns and scale, the live price column has none
+    const std::deque<IndicatorValues>& indicators = *symbol.indicators;
+    int indicatorSamples = std::min<int>(indicators.size(), width - 1);
+    int firstIndicatorColumn = width - 1 - indicatorSamples;
+    for (int x = 0; x < renderedChartWidth - 1; x += 1) {
+        int column = firstColumn + x;
+        if (column < firstIndicatorColumn) continue;
 
-        // run through rendered chart and remove everything before first non MISSING_PRICE value
-        while(renderedChart[0] == MISSING_PRICE){
-            renderedChart.erase(renderedChart.begin());
+        const IndicatorValues& values = indicators[indicators.size() - indicatorSamples + column - firstIndicatorColumn];
+        if (showBollinger_) {
+            renderIndicator(canvas, box, x + offsetX, values.upperBand, minValue, maxValue, bollingerRGB);
+            renderIndicator(canvas, box, x + offsetX, values.lowerBand, minValue, maxValue, bollingerRGB);
         }
-        
-        int renderedChartWidth = renderedChart.size();
-        for(int y = config_->getChartHeight(); y >= 0; y -= 1){
-            for(int x = 0; x < renderedChartWidth; x += 1){
-                matrix_->SetPixel(x + offsetX, matrix_->height() - y - 1, 0, 0, 0);
-                // skip missing timepoints
-                if (renderedChart[x] == MISSING_PRICE) continue;
-
-                if (y == (int)renderedChart[x]){
-                    matrix_->SetPixel(x + offsetX, matrix_->height() - y - 1, chartTopRGB[0], chartTopRGB[1], chartTopRGB[2]);
-                }
-                else if (y == 0 || y < renderedChart[x]){
-                    if ((x > 0 && y > renderedChart[x - 1]) || 
-                        (x < renderedChartWidth-1 && y > renderedChart[x + 1])){
-                        matrix_->SetPixel(x + offsetX, matrix_->height() - y - 1, chartTopRGB[0], chartTopRGB[1], chartTopRGB[2]);
-                    }
-                    else {
-                        matrix_->SetPixel(x + offsetX, matrix_->height() - y - 1, chartBaseRGB[0], chartBaseRGB[1], chartBaseRGB[2]);
-                    }
-                }          
-            }
+        if (showSma_) {
+            renderIndicator(canvas, box, x + offsetX, values.sma, minValue, maxValue, smaRGB);
+        }
+        if (showEma_) {
+            renderIndicator(canvas, box, x + offsetX, values.ema, minValue, maxValue, emaRGB);
         }
     }
+}
 
-    if (!savePrice) {
-        pastCharts_[symbol].pop_back();
-    }
+void Renderer::renderIndicator(rgb_matrix::Canvas* canvas, const WidgetBox& box, int x, double value, double minValue, double maxValue, const int rgb[3]) {
+    if (value == MISSING_PRICE) return;
+
+    int chartHeight = box.height - 1;
+    double y = minValue != maxValue ? (value - minValue) / (maxValue - minValue) * chartHeight : 0;
+    // bands wider than the price range are clipped rather than rescaling the chart
+    if (y < 0 || y > chartHeight) return;
+
+    canvas->SetPixel(x, box.y + box.height - 1 - (int)y, rgb[0], rgb[1], rgb[2]);
 }
 
-void Renderer::renderLogo(std::string logo, int size) {
-    if (logo == ""){
-        logoRendered_ = false; 
-        return;
-    }
-    if (!fs::exists(fs::path{logo})){
-        logoRendered_ = false; 
-        std::cout << "Logo not found: " << logo << std::endl;
-        return;
+bool Renderer::renderLogo(rgb_matrix::Canvas* canvas, const std::string& logo, int size) {
+    return renderLogo(canvas, logo, WidgetBox{0, canvas->height() - size, size, size});
+}
+
+bool Renderer::renderLogo(rgb_matrix::Canvas* canvas, const std::string& logo, const WidgetBox& box) {
+    if (logo.empty()){
+        return false;
     }
 
-    Mat image = imread(logo, IMREAD_COLOR | IMREAD_IGNORE_ORIENTATION);
+    std::shared_ptr<const Sprite> sprite = LogoCache::getInstance()->get(logo);
+    if (!sprite){
+        return false;
+    }
 
-    const int offsetX = 0, offsetY = matrix_->height() - size;
-    // Copy all the pixels to the matrix.
-    for (size_t y = 0; y < image.rows; y++) {
-        for (size_t x = 0; x < image.cols; x++) {
-            int blue = image.at<Vec3b>(y, x)[0];
-            int green = image.at<Vec3b>(y, x)[1];
-            int red = image.at<Vec3b>(y, x)[2];
-            matrix_->SetPixel(x + offsetX, y + offsetY,
-                            red,
-                            green,
-                            blue);
+    // Copy the pixels to the matrix, clipped to the box.
+    for (int y = 0; y < std::min(sprite->height, box.height); y++) {
+        const uint8_t* pixel = sprite->rgb.data() + y * sprite->width * 3;
+        for (int x = 0; x < std::min(sprite->width, box.width); x++) {
+            canvas->SetPixel(x + box.x, y + box.y,
+                            pixel[0],
+                            pixel[1],
+                            pixel[2]);
+            pixel += 3;
         }
     }
 
-    logoRendered_ = true;
+    return true;
 }
 
-void Renderer::renderSymbol(std::string symbol) {
+void Renderer::renderSymbol(rgb_matrix::Canvas* canvas, const std::string& symbol) {
     rgb_matrix::Color fontColor(255, 255, 255);
 
-    std::string bdfFontFile = "fonts/"+ std::to_string(SYMBOL_FONT_WIDTH) + \
-                                "x"+std::to_string(SYMBOL_FONT_HEIGHT) +".bdf";
     int xOrig = 2;
     int yOrig = 1;
     int letterSpacing = 0;
-    
-    //Load font. This needs to be a filename with a bdf bitmap font.
-    rgb_matrix::Font font;
-    if (!font.LoadFont(bdfFontFile.c_str())) {
-        fprintf(stderr, "Couldn't load font '%s'\n", bdfFontFile.c_str());
-        exit(1);
-    }
+    const rgb_matrix::Font& font = symbolFont_;
 
-    rgb_matrix::DrawText(matrix_, font, xOrig, yOrig + font.baseline(),
+    rgb_matrix::DrawText(canvas, font, xOrig, yOrig + font.baseline(),
                          fontColor, NULL, symbol.c_str(),
                          letterSpacing);
 
     // draw red vertial line on the left of symbol
     for (int y = yOrig; y < yOrig + font.baseline(); y += 1) {
-        matrix_->SetPixel(0, y, 255, 0, 0);
+        canvas->SetPixel(0, y, 255, 0, 0);
     }
 }
 
-void Renderer::renderGain(std::string symbol, double lastPrice) {
-    if (closedMarketPrices_[symbol] == ZERO_PRICE) {
-        closedMarketPrices_[symbol] = dataStorage_->closedMarketPrice(symbol);
-    }
-
-    if (lastPrice == MISSING_PRICE){
-        lastPrice = dataStorage_->getLastPrice(symbol);
-    }
-
-    double percentage = 0;
-    if (closedMarketPrices_[symbol] != ZERO_PRICE && lastPrice != ZERO_PRICE) {
-        percentage = ((lastPrice - closedMarketPrices_[symbol]) / closedMarketPrices_[symbol]) * 100;
-    }
-    std::ostringstream stream;
-    stream << std::fixed << std::setprecision(PERCENTAGE_PRECISION) << percentage;
-    std::string todaysGain = stream.str() + "%";
-    if (percentage > 0) {
-        todaysGain = "+" + todaysGain;
-    }
+void Renderer::renderGain(rgb_matrix::Canvas* canvas, const SymbolSnapshot& symbol) {
+    double percentage = gainPercentage(displayPrice(symbol), symbol.referencePrice);
+    // formatted into a stack buffer, the frame path does not allocate
+    char todaysGain[TEXT_BUFFER_SIZE];
+    int length = formatGain(todaysGain, percentage);
 
-    rgb_matrix::Color fontColor;    
-    if (percentage > 0.0){
-        fontColor = rgb_matrix::Color(0, 255, 0);
-    } else if (percentage < 0.0){
-        fontColor = rgb_matrix::Color(255, 0, 0);
-    } else {
-        fontColor = rgb_matrix::Color(255, 255, 255);
-    }
+    rgb_matrix::Color fontColor = gainColor(percentage);
 
-    std::string bdfFontFile = "fonts/"+ std::to_string(PERCENTAGE_FONT_WIDTH) + \
-                                "x"+std::to_string(PERCENTAGE_FONT_HEIGHT) +".bdf";
-    int xOrig = MATRIX_WIDTH-todaysGain.length()*PERCENTAGE_FONT_WIDTH;
+    int xOrig = MATRIX_WIDTH-length*PERCENTAGE_FONT_WIDTH;
     int yOrig = 1 + PERCENTAGE_FONT_HEIGHT + 1;
     int letterSpacing = 0;
-    
-    //Load font. This needs to be a filename with a bdf bitmap font.
-    rgb_matrix::Font font;
-    if (!font.LoadFont(bdfFontFile.c_str())) {
-        fprintf(stderr, "Couldn't load font '%s'\n", bdfFontFile.c_str());
-        exit(1);
-    }
+    const rgb_matrix::Font& font = percentageFont_;
 
     // clear previous text
     for (int y = yOrig; y < yOrig + font.baseline(); y += 1) {
         for (int x = xOrig-PERCENTAGE_FONT_WIDTH*2; \
-            x < std::min(static_cast<int>(xOrig + (todaysGain.length()+1)*PERCENTAGE_FONT_WIDTH), MATRIX_WIDTH); \
+            x < std::min(static_cast<int>(xOrig + (length+1)*PERCENTAGE_FONT_WIDTH), MATRIX_WIDTH); \
             x += 1) {
-            matrix_->SetPixel(x, y, 0, 0, 0);
+            canvas->SetPixel(x, y, 0, 0, 0);
         }
     }
 
-    rgb_matrix::DrawText(matrix_, font, xOrig, yOrig + font.baseline(),
-                         fontColor, NULL, todaysGain.c_str(),
+    rgb_matrix::DrawText(canvas, font, xOrig, yOrig + font.baseline(),
+                         fontColor, NULL, todaysGain,
                          letterSpacing);
 }
 
-void Renderer::renderPrice(std::string symbol, double lastPrice) {
-    if (lastPrice == MISSING_PRICE){
-        lastPrice = dataStorage_->getLastPrice(symbol);
-    }
+double Renderer::gainPercentage(double price, double referencePrice) {
+    if (referencePrice == ZERO_PRICE || price == ZERO_PRICE) return 0;
+    return ((price - referencePrice) / referencePrice) * 100;
+}
 
-    std::ostringstream stream;
-    stream << std::fixed << std::setprecision(5) << lastPrice;
-    std::string price = stream.str();
-    while (price.length() > 6) {
-        price = price.substr(0, price.length()-1);
+rgb_matrix::Color Renderer::gainColor(double percentage) {
+    if (percentage > 0.0){
+        return rgb_matrix::Color(0, 255, 0);
+    } else if (percentage < 0.0){
+        return rgb_matrix::Color(255, 0, 0);
     }
+    return rgb_matrix::Color(255, 255, 255);
+}
 
-    // if last price symbol is . then remove it
-    if (price[price.length()-1] == '.') {
-        price = price.substr(0, price.length()-1);
-    }
+void Renderer::renderPrice(rgb_matrix::Canvas* canvas, const SymbolSnapshot& symbol, bool logoRendered) {
+    double lastPrice = displayPrice(symbol);
 
-    price = "$" + price;
+    char price[TEXT_BUFFER_SIZE];
+    int length = formatPrice(price, lastPrice);
 
     rgb_matrix::Color fontColor(255, 255, 255);
     
-    std::string bdfFontFile = "fonts/"+ std::to_string(PRICE_FONT_WIDTH) + \
-                                "x"+std::to_string(PRICE_FONT_HEIGHT) +".bdf";
-    int xOrig = logoRendered_ ? MATRIX_WIDTH-price.length()*PRICE_FONT_WIDTH : 2;
-    int yOrig = logoRendered_ ? 1 : 1 + PRICE_FONT_HEIGHT + 1;
+    int xOrig = logoRendered ? MATRIX_WIDTH-length*PRICE_FONT_WIDTH : 2;
+    int yOrig = logoRendered ? 1 : 1 + PRICE_FONT_HEIGHT + 1;
     int letterSpacing = 0;
-
-    //Load font. This needs to be a filename with a bdf bitmap font.
-    rgb_matrix::Font font;
-    if (!font.LoadFont(bdfFontFile.c_str())) {
-        fprintf(stderr, "Couldn't load font '%s'\n", bdfFontFile.c_str());
-        exit(1);
-    }
+    const rgb_matrix::Font& font = priceFont_;
 
     // clear previous text
     for (int y = yOrig; y < yOrig + font.baseline()+1; y += 1) {
         for (int x = xOrig-PRICE_FONT_WIDTH; \
-            x < std::min(static_cast<int>(xOrig + (price.length() + 1) * PRICE_FONT_WIDTH), MATRIX_WIDTH); \
+            x < std::min(static_cast<int>(xOrig + (length + 1) * PRICE_FONT_WIDTH), MATRIX_WIDTH); \
             x += 1){
-            matrix_->SetPixel(x, y, 0, 0, 0);
+            canvas->SetPixel(x, y, 0, 0, 0);
         }
     }
 
-    rgb_matrix::DrawText(matrix_, font, xOrig, yOrig + font.baseline(),
-                         fontColor, NULL, price.c_str(),
+    rgb_matrix::DrawText(canvas, font, xOrig, yOrig + font.baseline(),
+                         fontColor, NULL, price,
                          letterSpacing);
 }
 
-void Renderer::renderEntireSymbol(int currentSymbolIndex, double price) {
-    std::string symbolName = config_->getSubsList()[currentSymbolIndex];
-    std::string apiSymbolName = config_->getApiSubsList()[currentSymbolIndex];
-    std::string logoSymbolName = config_->getLogoSubsList()[currentSymbolIndex];
+bool Renderer::renderStaticLayers(rgb_matrix::Canvas* canvas, const SymbolSnapshot& symbol) {
+    canvas->Fill(0, 0, 0);
+    canvas->Clear();
+    bool logoRendered = renderLogo(canvas, symbol.logoPath, config_->getLogoSize());
+    renderSymbol(canvas, symbol.name);
+    renderChart(canvas, symbol, logoRendered);
+    return logoRendered;
+}
 
-    matrix_->Fill(0, 0, 0);
-    matrix_->Clear();
-    renderLogo(LOGO_DIR+"/"+logoSymbolName+LOGO_EXT, config_->getLogoSize());
-    renderSymbol(symbolName);
-    renderPrice(apiSymbolName, price);
-    renderGain(apiSymbolName, price);
-    updateChart(apiSymbolName, price, false, true);
+void Renderer::renderDynamicLayers(rgb_matrix::Canvas* canvas, const SymbolSnapshot& symbol, bool logoRendered) {
+    renderPrice(canvas, symbol, logoRendered);
+    renderGain(canvas, symbol);
+}
+
+void Renderer::renderEntireSymbol(const SymbolSnapshot& symbol) {
+    rgb_matrix::Canvas* canvas = panel(matrix_);
+    logoRendered_ = renderStaticLayers(canvas, symbol);
+    renderDynamicLayers(canvas, symbol, logoRendered_);
+    publishFrame();
+}
+
+void Renderer::renderScene(const Scene& scene, const SymbolSnapshot& symbol) {
+    if (frameCanvas_ == nullptr) {
+        frameCanvas_ = matrix_->CreateFrameCanvas();
+    }
+
+    // static layers come from the cache, only the text is drawn now
+    rgb_matrix::Canvas* canvas = panel(frameCanvas_);
+    for (int y = 0; y < scene.canvas.height(); y += 1) {
+        for (int x = 0; x < scene.canvas.width(); x += 1) {
+            const uint8_t* p = scene.canvas.pixel(x, y);
+            canvas->SetPixel(x, y, p[0], p[1], p[2]);
+        }
+    }
+    renderDynamicLayers(canvas, symbol, scene.logoRendered);
+
+    frameCanvas_ = matrix_->SwapOnVSync(frameCanvas_);
+    logoRendered_ = scene.logoRendered;
+    publishFrame();
+}
+
+void Renderer::renderSymbolUpdate(const SymbolSnapshot& symbol) {
+    rgb_matrix::Canvas* canvas = panel(matrix_);
+    renderDynamicLayers(canvas, symbol, logoRendered_);
+    renderChart(canvas, symbol, logoRendered_);
+    publishFrame();
+}
+
+void Renderer::renderAlertBorder(bool lit) {
+    // blinks over the symbol, the caller redraws it once the alert is over
+    int r = lit ? alertRGB[0] : 0;
+    int g = lit ? alertRGB[1] : 0;
+    int b = lit ? alertRGB[2] : 0;
+    rgb_matrix::Canvas* canvas = panel(matrix_);
+    for (int x = 0; x < canvas->width(); x += 1) {
+        canvas->SetPixel(x, 0, r, g, b);
+        canvas->SetPixel(x, canvas->height() - 1, r, g, b);
+    }
+    for (int y = 0; y < canvas->height(); y += 1) {
+        canvas->SetPixel(0, y, r, g, b);
+        canvas->SetPixel(canvas->width() - 1, y, r, g, b);
+    }
+    publishFrame();
+}
+
+bool Renderer::hasLayout() const {
+    return !layout_.empty();
+}
+
+void Renderer::renderLayout(const MarketSnapshot& snapshot, int primaryIndex, int page) {
+    layout_.update(snapshot, primaryIndex, page);
+
+    rgb_matrix::Canvas* canvas = panel(matrix_);
+    bool drawn = layout_.takeCleared();
+    if (drawn) {
+        canvas->Fill(0, 0, 0);
+    }
+
+    // widgets whose data did not change keep their pixels
+    for (auto& widget : layout_.widgets()) {
+        if (!widget.dirty) continue;
+        clearBox(canvas, widget.box);
+        if (widget.symbol != nullptr) {
+            renderWidget(canvas, widget);
+        }
+        widget.dirty = false;
+        drawn = true;
+    }
+
+    if (drawn) {
+        publishFrame();
+    }
+}
+
+void Renderer::invalidateLayout() {
+    layout_.invalidate();
+}
+
+void Renderer::renderWidget(rgb_matrix::Canvas* canvas, const Widget& widget) {
+    const SymbolSnapshot& symbol = *widget.symbol;
+    const WidgetBox& box = widget.box;
+    char text[TEXT_BUFFER_SIZE];
+    rgb_matrix::Color white(255, 255, 255);
+
+    switch (widget.kind) {
+        case WidgetKind::Logo:
+            renderLogo(canvas, symbol.logoPath, box);
+            break;
+        case WidgetKind::Text:
+            renderText(canvas, symbolFont_, SYMBOL_FONT_WIDTH, box, box.y, symbol.name.c_str(), symbol.name.size(), white, false);
+            break;
+        case WidgetKind::Price: {
+            int length = formatPrice(text, displayPrice(symbol));
+            renderText(canvas, priceFont_, PRICE_FONT_WIDTH, box, box.y, text, length, white, true);
+            break;
+        }
+        case WidgetKind::Gain: {
+            double percentage = gainPercentage(displayPrice(symbol), symbol.referencePrice);
+            int length = formatGain(text, percentage);
+            renderText(canvas, percentageFont_, PERCENTAGE_FONT_WIDTH, box, box.y, text, length, gainColor(percentage), true);
+            break;
+        }
+        case WidgetKind::Sparkline:
+            renderChart(canvas, symbol, box);
+            break;
+        case WidgetKind::GridCell: {
+            // name on top, the gain below it when the cell is tall enough
+            double percentage = gainPercentage(displayPrice(symbol), symbol.referencePrice);
+            renderText(canvas, symbolFont_, SYMBOL_FONT_WIDTH, box, box.y + 1, symbol.name.c_str(), symbol.name.size(), white, false);
+            int gainY = box.y + 1 + SYMBOL_FONT_HEIGHT + 1;
+            if (gainY + PERCENTAGE_FONT_HEIGHT <= box.y + box.height) {
+                int length = formatGain(text, percentage);
+                renderText(canvas, percentageFont_, PERCENTAGE_FONT_WIDTH, box, gainY, text, length, gainColor(percentage), false);
+            }
+            break;
+        }
+    }
+}
+
+// One line of text at y, cut to the characters that fit the box so neighbours are never painted over.
+void Renderer::renderText(rgb_matrix::Canvas* canvas, const rgb_matrix::Font& font, int fontWidth, const WidgetBox& box,
+                          int y, const char* text, int length, const rgb_matrix::Color& color, bool rightAligned) {
+    char line[TEXT_BUFFER_SIZE];
+    length = std::min({length, box.width / fontWidth, TEXT_BUFFER_SIZE - 1});
+    if (length <= 0) return;
+    std::memcpy(line, text, length);
+    line[length] = '\0';
+
+    int x = rightAligned ? box.x + box.width - length * fontWidth : box.x;
+    rgb_matrix::DrawText(canvas, font, x, y + font.baseline(), color, NULL, line, 0);
+}
+
+void Renderer::clearBox(rgb_matrix::Canvas* canvas, const WidgetBox& box) {
+    for (int y = box.y; y < box.y + box.height; y += 1) {
+        for (int x = box.x; x < box.x + box.width; x += 1) {
+            canvas->SetPixel(x, y, 0, 0, 0);
+        }
+    }
+}
+
+// Drawing goes through the mirror while frames are exported, straight to the panel otherwise.
+rgb_matrix::Canvas* Renderer::panel(rgb_matrix::Canvas* target) {
+    if (!frameExport_.isOpen()) return target;
+
+    mirror_.setPanel(target);
+    return &mirror_;
+}
+
+void Renderer::publishFrame() {
+    frameExport_.publish(shadow_);
+}
+
+double Renderer::displayPrice(const SymbolSnapshot& symbol) const {
+    return symbol.price != MISSING_PRICE ? symbol.price : symbol.lastStoredPrice;
+}
+
+void Renderer::updateMarqueeSegment(int symbolIndex, const SymbolSnapshot& symbol, int symbolsCount) {
+    if (strip_.width() != symbolsCount * MATRIX_WIDTH) {
+        // subscriptions changed, the strip grows or shrinks by one panel per symbol
+        strip_.resize(symbolsCount * MATRIX_WIDTH, matrix_->height());
+        segmentVersions_.assign(symbolsCount, -1);
+    }
+
+    // only segments whose symbol changed since the last pass are redrawn
+    if (segmentVersions_[symbolIndex] == symbol.version) {
+        return;
+    }
+
+    CanvasView segment(&strip_, symbolIndex * MATRIX_WIDTH, MATRIX_WIDTH);
+    bool logoRendered = renderStaticLayers(&segment, symbol);
+    renderDynamicLayers(&segment, symbol, logoRendered);
+
+    segmentVersions_[symbolIndex] = symbol.version;
+}
+
+void Renderer::renderMarqueeFrame(int offset) {
+    if (strip_.width() == 0) return;
+
+    if (frameCanvas_ == nullptr) {
+        frameCanvas_ = matrix_->CreateFrameCanvas();
+    }
+
+    // copy one panel-wide window of the strip, wrapping around its end
+    rgb_matrix::Canvas* canvas = panel(frameCanvas_);
+    for (int x = 0; x < MATRIX_WIDTH; x += 1) {
+        int stripX = (offset + x) % strip_.width();
+        for (int y = 0; y < strip_.height(); y += 1) {
+            const uint8_t* p = strip_.pixel(stripX, y);
+            canvas->SetPixel(x, y, p[0], p[1], p[2]);
+        }
+    }
+
+    frameCanvas_ = matrix_->SwapOnVSync(frameCanvas_);
+    publishFrame();
 }
 
-void Renderer::clearPastCharts(){
-    // clear past chart map for the symbol
-    pastCharts_ = std::unordered_map<std::string, std::deque<double>>();
-    closedMarketPrices_ = std::unordered_map<std::string, double>();
+int Renderer::getMarqueeWidth() const {
+    return strip_.width();
 }
 
 rgb_matrix::RGBMatrix* Renderer::getMatrix() {
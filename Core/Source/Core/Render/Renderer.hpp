@@ -4,8 +4,12 @@
 #include "led-matrix.h"
 #include "graphics.h"
 #include <algorithm>
+#include <array>
+#include <charconv>
+#include <cstring>
 #include <iostream>
 #include <deque>
+#include <set>
 #include <unordered_map>
 #include <iomanip>
 #include <sstream>
@@ -13,9 +17,15 @@
 #include <cstdlib> // for rand() and srand()
 #include <ctime>   // for time()
 #include <unistd.h> // for sleep
-#include "Core/Database/DataStorage.hpp"
+#include "Core/Market/MarketState.hpp"
 #include "Core/Config.hpp"
 #include "Core/GlobalParams.hpp"
+#include "Core/Render/FrameExport.hpp"
+#include "Core/Render/Layout.hpp"
+#include "Core/Render/OffscreenCanvas.hpp"
+#include "Core/Render/Scene.hpp"
+#include "Core/Render/TextFormat.hpp"
+#include "Core/System/ThreadPlacement.hpp"
 
 constexpr int MATRIX_WIDTH = 64;
 constexpr int GPIO_SLOWDOWN = 4;
@@ -26,7 +36,9 @@ constexpr int LOGO_CHART_GAP = 1;
 constexpr int SYMBOL_LEFT_SPACING = 2;
 constexpr int SYMBOL_TOP_SPACING = 1;
 
-constexpr int PERCENTAGE_PRECISION = 2;
+const std::string MARQUEE_DISPLAY_MODE = "marquee";
+constexpr int MARQUEE_FPS = 60;
+constexpr int RENDER_FPS = 20;
 
 constexpr int PERCENTAGE_FONT_WIDTH = 4;
 constexpr int PERCENTAGE_FONT_HEIGHT = 6;
@@ -35,36 +47,89 @@ constexpr int PRICE_FONT_HEIGHT = 6;
 constexpr int SYMBOL_FONT_WIDTH = 5;
 constexpr int SYMBOL_FONT_HEIGHT = 7;
 
+constexpr int ALERT_FLASH_TIME = 6; // in seconds
+constexpr int ALERT_BLINK_TIME = 250; // in milliseconds
+
+const int alertRGB[3] = {255, 0, 0};
 const int chartBaseRGB[3] = {0, 140, 0};
-const int chartTopRGB[3] = {0, 255, 90};   
+const int chartTopRGB[3] = {0, 255, 90};
+const int smaRGB[3] = {255, 160, 0};
+const int emaRGB[3] = {0, 140, 255};
+const int bollingerRGB[3] = {110, 0, 160};   
 
 class Renderer {
 public:
     Renderer();
     ~Renderer();
 
-    void updateChart(std::string symbol, double lastPrice, bool savePrice, bool toRender);
-    void renderGain(std::string symbol, double lastPrice);
-    void renderLogo(std::string logo, int size);
-    void renderSymbol(std::string symbol);
-    void renderPrice(std::string symbol, double lastPrice);
-    void renderEntireSymbol(int currentSymbolIndex, double price);
-    void clearPastCharts();
+    // Drawing helpers take their target, so scenes can be painted off-screen
+    // on another thread while frames go to the matrix.
+    void renderChart(rgb_matrix::Canvas* canvas, const SymbolSnapshot& symbol, bool logoRendered);
+    void renderChart(rgb_matrix::Canvas* canvas, const SymbolSnapshot& symbol, const WidgetBox& box);
+    void renderGain(rgb_matrix::Canvas* canvas, const SymbolSnapshot& symbol);
+    bool renderLogo(rgb_matrix::Canvas* canvas, const std::string& logo, int size);
+    bool renderLogo(rgb_matrix::Canvas* canvas, const std::string& logo, const WidgetBox& box);
+    void renderSymbol(rgb_matrix::Canvas* canvas, const std::string& symbol);
+    void renderPrice(rgb_matrix::Canvas* canvas, const SymbolSnapshot& symbol, bool logoRendered);
+    bool renderStaticLayers(rgb_matrix::Canvas* canvas, const SymbolSnapshot& symbol);
+    void renderDynamicLayers(rgb_matrix::Canvas* canvas, const SymbolSnapshot& symbol, bool logoRendered);
+
+    void renderEntireSymbol(const SymbolSnapshot& symbol);
+    void renderScene(const Scene& scene, const SymbolSnapshot& symbol);
+    void renderSymbolUpdate(const SymbolSnapshot& symbol);
+    void renderAlertBorder(bool lit);
+
+    // Layout mode: the widgets of the Layout option, only the dirty ones are drawn.
+    bool hasLayout() const;
+    void renderLayout(const MarketSnapshot& snapshot, int primaryIndex, int page);
+    void invalidateLayout();
+
+    // Marquee mode: every symbol is pre-rendered into one panel-wide segment
+    // of an off-screen strip, and frames are windows scrolled across it.
+    void updateMarqueeSegment(int symbolIndex, const SymbolSnapshot& symbol, int symbolsCount);
+    void renderMarqueeFrame(int offset);
+    int getMarqueeWidth() const;
 
     rgb_matrix::RGBMatrix* getMatrix();
 
 private:
-    std::unordered_map<std::string, double> closedMarketPrices_;
-    std::unordered_map<std::string, std::deque<double>> pastCharts_;
-
-    DataStorage* dataStorage_ = DataStorage::getInstance();
+    double displayPrice(const SymbolSnapshot& symbol) const;
+    static void loadFont(rgb_matrix::Font& font, int width, int height);
+    void renderIndicator(rgb_matrix::Canvas* canvas, const WidgetBox& box, int x, double value, double minValue, double maxValue, const int rgb[3]);
+    void renderWidget(rgb_matrix::Canvas* canvas, const Widget& widget);
+    static void renderText(rgb_matrix::Canvas* canvas, const rgb_matrix::Font& font, int fontWidth, const WidgetBox& box,
+                           int y, const char* text, int length, const rgb_matrix::Color& color, bool rightAligned);
+    static void clearBox(rgb_matrix::Canvas* canvas, const WidgetBox& box);
+    static rgb_matrix::Color gainColor(double percentage);
+    static double gainPercentage(double price, double referencePrice);
+    rgb_matrix::Canvas* panel(rgb_matrix::Canvas* target);
+    void publishFrame();
 
     rgb_matrix::RGBMatrix* matrix_;
+    rgb_matrix::FrameCanvas* frameCanvas_ = nullptr;
     rgb_matrix::RGBMatrix::Options matrixOptions_;
 
     Config *config_ = Config::getInstance(CONFIG_FILE);
 
     bool logoRendered_ = false;
+
+    rgb_matrix::Font symbolFont_;
+    rgb_matrix::Font priceFont_;
+    rgb_matrix::Font percentageFont_;
+
+    bool showSma_ = false;
+    bool showEma_ = false;
+    bool showBollinger_ = false;
+
+    Layout layout_;
+
+    OffscreenCanvas strip_;
+    std::vector<long long> segmentVersions_;
+
+    // what the panel shows, mirrored while frames are exported to shared memory
+    OffscreenCanvas shadow_;
+    MirrorCanvas mirror_{&shadow_};
+    FrameExport frameExport_;
 };
 
 #endif // RENDERER_HPP
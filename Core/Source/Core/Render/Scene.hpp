@@ -0,0 +1,24 @@
+#ifndef SCENE_HPP
+#define SCENE_HPP
+
+#include <chrono>
+#include <deque>
+#include <memory>
+#include <string>
+#include "Core/Render/OffscreenCanvas.hpp"
+
+// Pre-rendered static layers of one symbol (logo, name and chart), together
+// with the data they were drawn from, so the cache can tell when they went stale.
+struct Scene {
+    OffscreenCanvas canvas;
+    bool logoRendered = false;
+
+    std::string name;
+    std::string logo;
+    std::shared_ptr<const std::deque<double>> chart;
+    double price = 0;
+
+    std::chrono::steady_clock::time_point renderedAt;
+};
+
+#endif // SCENE_HPP
@@ -0,0 +1,72 @@
+#include "SceneCache.hpp"
+
+SceneCache::SceneCache(Renderer& renderer) : renderer_(renderer) {}
+
+void SceneCache::refresh(const MarketSnapshot& snapshot) {
+    std::unordered_map<std::string, std::shared_ptr<const Scene>> scenes;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        scenes = scenes_;
+    }
+
+    std::unordered_map<std::string, std::shared_ptr<const Scene>> refreshed;
+    int paints = 0;
+    auto refresh = [&](const SymbolSnapshot& symbol) {
+        if (!symbol.hot) return;
+
+        auto it = scenes.find(symbol.apiName);
+        bool stale = it == scenes.end() || isStale(*it->second, symbol);
+        if (!stale || paints == SCENE_PAINTS_PER_REFRESH) {
+            // over budget a stale scene is still better than none, it is repainted next time
+            if (it != scenes.end()) {
+                refreshed[symbol.apiName] = it->second;
+            }
+            return;
+        }
+        paints += 1;
+
+        // painted outside the lock, the render thread keeps using the old scene meanwhile
+        auto scene = std::make_shared<Scene>();
+        scene->canvas.resize(MATRIX_WIDTH, renderer_.getMatrix()->height());
+        scene->logoRendered = renderer_.renderStaticLayers(&scene->canvas, symbol);
+        scene->name = symbol.name;
+        scene->logo = symbol.logo;
+        scene->chart = symbol.chart;
+        scene->price = symbol.price;
+        scene->renderedAt = std::chrono::steady_clock::now();
+        refreshed[symbol.apiName] = scene;
+    };
+
+    // the hot symbols are looked up by index, only the start before the first switch has them all
+    if (snapshot.hot.empty()) {
+        for (const auto& symbol : snapshot.symbols) {
+            refresh(symbol);
+        }
+    }
+    for (size_t i : snapshot.hot) {
+        refresh(snapshot.symbols[i]);
+    }
+
+    // scenes of unsubscribed and cooled down symbols are dropped
+    std::lock_guard<std::mutex> lock(mutex_);
+    scenes_.swap(refreshed);
+}
+
+std::shared_ptr<const Scene> SceneCache::find(const std::string& apiSymbol) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    auto it = scenes_.find(apiSymbol);
+    if (it == scenes_.end()) return nullptr;
+    return it->second;
+}
+
+bool SceneCache::isStale(const Scene& scene, const SymbolSnapshot& symbol) const {
+    if (scene.name != symbol.name || scene.logo != symbol.logo || scene.chart != symbol.chart) {
+        return true;
+    }
+
+    // the live price only rescales the chart, and a logo may have been downloaded
+    // since, so those are picked up at a slower pace
+    bool aged = std::chrono::steady_clock::now() - scene.renderedAt > std::chrono::seconds(SCENE_REFRESH_TIME);
+    return aged && (scene.price != symbol.price || !scene.logoRendered);
+}
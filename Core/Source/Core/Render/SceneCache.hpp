@@ -0,0 +1,35 @@
+#ifndef SCENE_CACHE_HPP
+#define SCENE_CACHE_HPP
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include "Core/Market/MarketState.hpp"
+#include "Core/Render/Renderer.hpp"
+#include "Core/Render/Scene.hpp"
+
+constexpr int SCENE_REFRESH_TIME = 5; // in seconds
+constexpr int SCENE_PAINTS_PER_REFRESH = 4;
+
+// Off-screen scenes for the hot tier, the symbol on screen and the ones up
+// next. refresh() runs on a background thread and repaints scenes whose
+// data changed, a bounded number per call however long the watchlist, so
+// switching symbols only has to copy a finished scene and draw the text over it.
+class SceneCache {
+public:
+    SceneCache(Renderer& renderer);
+
+    void refresh(const MarketSnapshot& snapshot);
+    std::shared_ptr<const Scene> find(const std::string& apiSymbol) const;
+
+private:
+    bool isStale(const Scene& scene, const SymbolSnapshot& symbol) const;
+
+    Renderer& renderer_;
+
+    std::unordered_map<std::string, std::shared_ptr<const Scene>> scenes_;
+    mutable std::mutex mutex_;
+};
+
+#endif // SCENE_CACHE_HPP
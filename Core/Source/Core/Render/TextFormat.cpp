@@ -0,0 +1,33 @@
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+#include "TextFormat.hpp"
+
+// "$" and at most six characters of the price, without a trailing '.'
+int formatPrice(char* buffer, double price) {
+    char digits[TEXT_BUFFER_SIZE];
+    auto result = std::to_chars(digits, digits + sizeof(digits), price, std::chars_format::fixed, 5);
+    int length = std::min<int>(result.ptr - digits, 6);
+    if (length > 0 && digits[length - 1] == '.') {
+        length -= 1;
+    }
+
+    buffer[0] = '$';
+    std::memcpy(buffer + 1, digits, length);
+    buffer[length + 1] = '\0';
+    return length + 1;
+}
+
+// signed percentage with PERCENTAGE_PRECISION decimals, e.g. "+1.25%"
+int formatGain(char* buffer, double percentage) {
+    int length = 0;
+    if (percentage > 0) {
+        buffer[length++] = '+';
+    }
+    auto result = std::to_chars(buffer + length, buffer + TEXT_BUFFER_SIZE - 2, percentage,
+                                std::chars_format::fixed, PERCENTAGE_PRECISION);
+    length = result.ptr - buffer;
+    buffer[length++] = '%';
+    buffer[length] = '\0';
+    return length;
+}
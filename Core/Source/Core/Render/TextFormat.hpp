@@ -0,0 +1,12 @@
+#ifndef TEXT_FORMAT_HPP
+#define TEXT_FORMAT_HPP
+
+constexpr int PERCENTAGE_PRECISION = 2;
+constexpr int TEXT_BUFFER_SIZE = 32;
+
+// Panel texts, written into a buffer of TEXT_BUFFER_SIZE without allocating
+// since they are redrawn every frame. Return the length of the text.
+int formatPrice(char* buffer, double price);
+int formatGain(char* buffer, double percentage);
+
+#endif // TEXT_FORMAT_HPP
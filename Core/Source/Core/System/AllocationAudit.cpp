@@ -0,0 +1,75 @@
+#include <atomic>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include "AllocationAudit.hpp"
+
+namespace {
+    constexpr long long LOGGED_VIOLATIONS = 20;   // later ones are only counted
+
+    thread_local long long threadAllocations = 0;
+
+    std::atomic<bool> armed = false;
+    std::atomic<long long> violationCount = 0;
+    std::atomic<long long> allocationCount = 0;
+}
+
+#ifdef ALLOCATION_AUDIT
+// The array and nothrow forms forward to these, aligned allocations are not counted.
+void* operator new(std::size_t size) {
+    threadAllocations += 1;
+    if (void* memory = std::malloc(size == 0 ? 1 : size)) {
+        return memory;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* memory) noexcept {
+    std::free(memory);
+}
+
+void operator delete(void* memory, std::size_t) noexcept {
+    std::free(memory);
+}
+#endif
+
+bool AllocationAudit::enabled() {
+#ifdef ALLOCATION_AUDIT
+    return true;
+#else
+    return false;
+#endif
+}
+
+void AllocationAudit::arm() {
+    if (enabled() && !armed.exchange(true)) {
+        std::cout << "Allocation audit armed" << std::endl;
+    }
+}
+
+long long AllocationAudit::violations() {
+    return violationCount;
+}
+
+long long AllocationAudit::allocations() {
+    return allocationCount;
+}
+
+void AllocationAudit::report() {
+    if (!armed) return;
+
+    std::cout << "Allocation audit: " << violations() << " steady-state scopes allocated, "
+              << allocations() << " allocations" << std::endl;
+}
+
+AllocationScope::AllocationScope(const char* name) : name_(name), start_(threadAllocations) {}
+
+AllocationScope::~AllocationScope() {
+    long long made = threadAllocations - start_;
+    if (made == 0 || !armed) return;
+
+    allocationCount += made;
+    if (violationCount++ < LOGGED_VIOLATIONS) {
+        std::cerr << "Allocation audit: " << made << " allocations in " << name_ << std::endl;
+    }
+}
@@ -0,0 +1,34 @@
+#ifndef ALLOCATION_AUDIT_HPP
+#define ALLOCATION_AUDIT_HPP
+
+// Counts heap allocations made inside the steady-state scopes, parsing a feed
+// message and rendering a frame, once the session is warmed up. Only builds
+// defining ALLOCATION_AUDIT (the Debug configuration) replace operator new,
+// elsewhere the scopes compare two unchanging counters.
+class AllocationAudit {
+public:
+    static bool enabled();
+
+    // Warm-up is over, allocations inside scopes count as violations from now on.
+    static void arm();
+
+    static long long violations();    // scopes that allocated
+    static long long allocations();   // allocations made by them
+
+    static void report();
+};
+
+class AllocationScope {
+public:
+    explicit AllocationScope(const char* name);
+    ~AllocationScope();
+
+private:
+    AllocationScope(const AllocationScope&);
+    AllocationScope& operator=(const AllocationScope&);
+
+    const char* name_;
+    long long start_;
+};
+
+#endif // ALLOCATION_AUDIT_HPP
@@ -0,0 +1,38 @@
+#include <chrono>
+#include "Clock.hpp"
+
+Clock* Clock::instance_ = nullptr;
+
+// singleton
+Clock* Clock::getInstance() {
+   if (instance_ == nullptr) {
+      instance_ = new Clock();
+   }
+   return instance_;
+}
+
+long long Clock::now() const {
+    return nowMilliseconds() / 1000;
+}
+
+long long Clock::nowMilliseconds() const {
+    if (simulated_) return simulatedTime_;
+
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+void Clock::simulate(long long startMilliseconds) {
+    simulatedTime_ = startMilliseconds;
+    simulated_ = true;
+}
+
+void Clock::advanceTo(long long milliseconds) {
+    if (milliseconds > simulatedTime_) {
+        simulatedTime_ = milliseconds;
+    }
+}
+
+bool Clock::isSimulated() const {
+    return simulated_;
+}
@@ -0,0 +1,34 @@
+#ifndef CLOCK_HPP
+#define CLOCK_HPP
+
+#include <atomic>
+
+// Wall time as the session sees it: sampling, symbol switching, staleness,
+// alert cooldowns and every timestamp written to the database. It follows
+// the system clock, unless the simulation driver took it over to replay a
+// scripted day faster than real time. Connection health and frame pacing
+// measure real time and keep using steady_clock.
+class Clock {
+
+public:
+    static Clock* getInstance();
+
+    long long now() const;                // in seconds since epoch
+    long long nowMilliseconds() const;
+
+    // From here on the clock only moves when advanced.
+    void simulate(long long startMilliseconds);
+    void advanceTo(long long milliseconds);
+    bool isSimulated() const;
+
+private:
+    static Clock* instance_;   // The one, single instance
+    Clock() = default; // private constructor
+    Clock(const Clock&);
+    Clock& operator=(const Clock&);
+
+    std::atomic<bool> simulated_ = false;
+    std::atomic<long long> simulatedTime_ = 0;   // in milliseconds
+};
+
+#endif // CLOCK_HPP
@@ -0,0 +1,141 @@
+#include <sched.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include "ThreadPlacement.hpp"
+#include "Core/Config.hpp"
+#include "Core/GlobalParams.hpp"
+
+namespace fs = std::filesystem;
+
+ThreadPlacement* ThreadPlacement::instance_ = nullptr;
+
+// singleton
+ThreadPlacement* ThreadPlacement::getInstance() {
+   if (instance_ == nullptr) {
+      instance_ = new ThreadPlacement();
+   }
+   return instance_;
+}
+
+// <role>=<cpu>[,<cpu>...][:<fifo priority>]
+ThreadPlacement::ThreadPlacement() : lastReport_(std::chrono::steady_clock::now()) {
+    for (const auto& entry : Config::getInstance(CONFIG_FILE)->getThreadPlacement()) {
+        size_t separator = entry.find('=');
+        if (separator == std::string::npos) {
+            std::cerr << "Ignoring thread placement without '=': " << entry << std::endl;
+            continue;
+        }
+
+        Placement placement;
+        std::string spec = entry.substr(separator + 1);
+        size_t priority = spec.find(':');
+        try {
+            if (priority != std::string::npos) {
+                placement.fifoPriority = std::stoi(spec.substr(priority + 1));
+                spec = spec.substr(0, priority);
+            }
+            std::istringstream cpus(spec);
+            std::string cpu;
+            while (std::getline(cpus, cpu, ',')) {
+                if (!cpu.empty()) placement.cpus.push_back(std::stoi(cpu));
+            }
+        } catch (const std::exception& e) {
+            std::cerr << "Ignoring invalid thread placement: " << entry << std::endl;
+            continue;
+        }
+        placements_[entry.substr(0, separator)] = placement;
+    }
+}
+
+void ThreadPlacement::apply(const std::string& role) {
+    apply(role, {static_cast<pid_t>(syscall(SYS_gettid))});
+}
+
+void ThreadPlacement::apply(const std::string& role, const std::set<pid_t>& threads) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (pid_t thread : threads) {
+        place(role, thread);
+    }
+}
+
+void ThreadPlacement::place(const std::string& role, pid_t thread) {
+    threads_[thread] = role;
+    readUsage(thread, lastUsage_[thread]);
+
+    auto it = placements_.find(role);
+    if (it == placements_.end()) return;
+    const Placement& placement = it->second;
+
+    if (!placement.cpus.empty()) {
+        cpu_set_t cpus;
+        CPU_ZERO(&cpus);
+        for (int cpu : placement.cpus) {
+            CPU_SET(cpu, &cpus);
+        }
+        if (sched_setaffinity(thread, sizeof(cpus), &cpus) != 0) {
+            std::cerr << "Could not pin " << role << " thread " << thread << ": " << std::strerror(errno) << std::endl;
+        }
+    }
+
+    if (placement.fifoPriority > 0) {
+        sched_param param{};
+        param.sched_priority = placement.fifoPriority;
+        // needs CAP_SYS_NICE, the matrix library already requires running as root
+        if (sched_setscheduler(thread, SCHED_FIFO, &param) != 0) {
+            std::cerr << "Could not set SCHED_FIFO for " << role << " thread " << thread << ": " << std::strerror(errno) << std::endl;
+        }
+    }
+
+    std::cout << "Placed " << role << " thread " << thread << std::endl;
+}
+
+std::set<pid_t> ThreadPlacement::processThreads() {
+    std::set<pid_t> threads;
+    std::error_code error;
+    for (const auto& task : fs::directory_iterator("/proc/self/task", error)) {
+        try {
+            threads.insert(std::stoi(task.path().filename().string()));
+        } catch (const std::exception&) {
+        }
+    }
+    return threads;
+}
+
+// schedstat holds the time spent on the CPU, the time spent waiting on a run queue and the timeslices run
+bool ThreadPlacement::readUsage(pid_t thread, Usage& usage) {
+    std::ifstream file("/proc/self/task/" + std::to_string(thread) + "/schedstat");
+    return static_cast<bool>(file >> usage.cpuTime >> usage.waitTime);
+}
+
+void ThreadPlacement::reportCheck() {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    auto now = std::chrono::steady_clock::now();
+    if (now - lastReport_ < std::chrono::seconds(THREAD_REPORT_TIME)) return;
+    double interval = std::chrono::duration<double>(now - lastReport_).count();
+    lastReport_ = now;
+
+    for (auto it = threads_.begin(); it != threads_.end();) {
+        Usage usage;
+        if (!readUsage(it->first, usage)) {
+            // the thread has exited
+            lastUsage_.erase(it->first);
+            it = threads_.erase(it);
+            continue;
+        }
+
+        Usage& last = lastUsage_[it->first];
+        double cpu = (usage.cpuTime - last.cpuTime) / 1e9;
+        double wait = (usage.waitTime - last.waitTime) / 1e9;
+        std::cout << "Thread " << it->second << " (" << it->first << "): "
+                  << static_cast<int>(cpu / interval * 100) << "% CPU, "
+                  << static_cast<long long>(wait * 1000) << "ms waiting to run" << std::endl;
+        last = usage;
+        ++it;
+    }
+}
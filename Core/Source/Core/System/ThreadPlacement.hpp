@@ -0,0 +1,66 @@
+#ifndef THREAD_PLACEMENT_HPP
+#define THREAD_PLACEMENT_HPP
+
+#include <sys/types.h>
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+#include <vector>
+
+const std::string MATRIX_THREAD_ROLE = "matrix";
+const std::string RENDER_THREAD_ROLE = "render";
+const std::string SCENE_THREAD_ROLE = "scene";
+const std::string STORAGE_THREAD_ROLE = "storage";
+const std::string INGEST_THREAD_ROLE = "ingest";
+
+constexpr int THREAD_REPORT_TIME = 60; // in seconds
+
+// Pins threads to CPUs and optionally gives them SCHED_FIFO priorities,
+// per role, from the Thread_Placement option, e.g.
+//   Thread_Placement = matrix=3:99 render=2:50 ingest=1 storage=0,1
+// and reports the CPU time and run queue delay of every placed thread
+// from /proc/self/task/<tid>/schedstat.
+class ThreadPlacement {
+
+public:
+    static ThreadPlacement* getInstance();
+
+    // Places the calling thread.
+    void apply(const std::string& role);
+    // Places threads started by a library, e.g. the matrix refresh thread.
+    void apply(const std::string& role, const std::set<pid_t>& threads);
+
+    static std::set<pid_t> processThreads();
+
+    void reportCheck();
+
+private:
+    struct Placement {
+        std::vector<int> cpus;      // empty keeps the inherited affinity
+        int fifoPriority = 0;       // 0 keeps SCHED_OTHER
+    };
+
+    struct Usage {
+        unsigned long long cpuTime = 0;   // in nanoseconds
+        unsigned long long waitTime = 0;  // in nanoseconds
+    };
+
+    static ThreadPlacement* instance_;   // The one, single instance
+    ThreadPlacement(); // private constructor
+    ThreadPlacement(const ThreadPlacement&);
+    ThreadPlacement& operator=(const ThreadPlacement&);
+
+    void place(const std::string& role, pid_t thread);
+    static bool readUsage(pid_t thread, Usage& usage);
+
+    std::map<std::string, Placement> placements_;
+    std::map<pid_t, std::string> threads_;   // placed threads and their roles
+    std::map<pid_t, Usage> lastUsage_;
+    std::chrono::steady_clock::time_point lastReport_;
+
+    std::mutex mutex_;
+};
+
+#endif // THREAD_PLACEMENT_HPP
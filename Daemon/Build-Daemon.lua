@@ -0,0 +1,49 @@
+project "Daemon"
+   kind "ConsoleApp"
+   language "C++"
+   cppdialect "C++20"
+   targetdir "Binaries/%{cfg.buildcfg}"
+   staticruntime "off"
+
+   files { "Source/**.h", "Source/**.cpp" }
+
+   includedirs
+   {
+      "Source",
+      -- Include Core
+      "../Core/Source"
+   }
+
+   -- only the ingest half of Core is linked, the daemon drives no panel
+   links {  
+      "Core", "crypto", "ssl", "cpprest", 
+      "boost_program_options", "jsoncpp",
+      "pqxx",
+      "rt",         -- Add rt library
+      "m",          -- Add math library
+      "pthread"     -- Add pthread library
+   }
+
+   targetdir ("../Binaries/" .. OutputDir .. "/%{prj.name}")
+   objdir ("../Binaries/Intermediates/" .. OutputDir .. "/%{prj.name}")
+
+   filter "system:windows"
+       systemversion "latest"
+       defines { "WINDOWS" }
+ 
+   filter "configurations:Debug"
+       defines { "DEBUG" }
+       runtime "Debug"
+       symbols "On"
+
+   filter "configurations:Release"
+       defines { "RELEASE" }
+       runtime "Release"
+       optimize "On"
+       symbols "On"
+
+   filter "configurations:Dist"
+       defines { "DIST" }
+       runtime "Release"
+       optimize "On"
+       symbols "Off"
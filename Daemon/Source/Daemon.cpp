@@ -0,0 +1,10 @@
+#include <iostream>
+//Daemon Headers
+#include "Core/Api/FeedDaemon.hpp"
+
+int main(int argc, const char * argv[]) {
+    FeedDaemon daemon;
+    daemon.runForever();
+
+    return 0;
+}
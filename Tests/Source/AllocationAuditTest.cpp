@@ -0,0 +1,93 @@
+#include <memory>
+#include <string>
+#include <vector>
+#include "Check.hpp"
+#include "Core/Api/Providers/FinnhubProvider.hpp"
+#include "Core/Market/AlertEngine.hpp"
+#include "Core/Market/MarketState.hpp"
+#include "Core/Render/TextFormat.hpp"
+#include "Core/System/AllocationAudit.hpp"
+
+namespace {
+    constexpr int TICK_PATH_PASSES = 200;
+    constexpr int CHART_LENGTH = 64;   // the panel width
+
+    std::string tradeMessage(double price) {
+        return R"({"data":[{"p":)" + std::to_string(price) + R"(,"s":"BINANCE:BTCUSDT","t":1575526691134,"v":0.011,"c":null},)" +
+               R"({"p":)" + std::to_string(price / 40) + R"(,"s":"AAPL","t":1575526691135,"v":10,"c":null}],"type":"trade"})";
+    }
+
+    // What a feed thread does with a trade message (FeedConnection::onMessage and
+    // Session::processTicks) and the matrix-free start of a render frame.
+    void tickPath(const MarketDataProvider& provider, const std::string& message, MarketState& market, AlertEngine& alerts) {
+        thread_local std::vector<Tick> ticks;
+        thread_local std::string apiSymbol;
+        ticks.clear();
+        CHECK(provider.parse(message, ticks));
+        for (const auto& tick : ticks) {
+            apiSymbol.assign(tick.symbol);
+            alerts.onTick(apiSymbol, tick.price, tick.time);
+            market.updatePrice(apiSymbol, tick.price, tick.time);
+        }
+
+        auto snapshot = market.snapshot();
+        char text[TEXT_BUFFER_SIZE];
+        for (const auto& symbol : snapshot->symbols) {
+            CHECK(formatPrice(text, symbol.price) > 1);
+            CHECK(formatGain(text, (symbol.price - 100) / 100 * 100) > 1);
+        }
+    }
+
+    // Allocations on the tick path after warm-up, so one creeping back fails the run.
+    void tickPathTest() {
+        FinnhubProvider provider("", 50);
+        MarketState market(CHART_LENGTH);
+        market.setSymbols({"BTC", "AAPL"}, {"BINANCE:BTCUSDT", "AAPL"}, {"", ""});
+        AlertEngine alerts;
+        alerts.setRules({{"btc-above", "BINANCE:BTCUSDT", AlertType::Above, 1e6},
+                         {"aapl-below", "AAPL", AlertType::Below, 1},
+                         {"aapl-move", "AAPL", AlertType::PercentMove, 50}});
+        alerts.setReference("AAPL", 180);
+
+        // every pass trades at a new price, so every frame publishes a new snapshot
+        std::vector<std::string> messages;
+        for (int i = 0; i < TICK_PATH_PASSES; i += 1) {
+            messages.push_back(tradeMessage(7000 + i * 0.25));
+        }
+
+        // warm-up: thread-local buffers and the snapshot pool settle
+        for (int i = 0; i < TICK_PATH_PASSES / 2; i += 1) {
+            tickPath(provider, messages[i], market, alerts);
+        }
+
+        AllocationAudit::arm();
+        long long violations = AllocationAudit::violations();
+        for (int i = TICK_PATH_PASSES / 2; i < TICK_PATH_PASSES; i += 1) {
+            AllocationScope scope("tick path");
+            tickPath(provider, messages[i], market, alerts);
+        }
+        CHECK(AllocationAudit::violations() == violations);
+    }
+}
+
+// Only audited builds (Debug) count allocations, the counters never move elsewhere.
+void allocationAuditTest() {
+    if (!AllocationAudit::enabled()) {
+        std::cout << "Allocation audit not built in, skipped" << std::endl;
+        return;
+    }
+
+    AllocationAudit::arm();
+    long long violations = AllocationAudit::violations();
+    {
+        AllocationScope scope("test with an allocation");
+        // kept beyond the scope, an allocation that does not escape may be optimized away
+        static std::unique_ptr<int> value;
+        value = std::make_unique<int>(1);
+        CHECK(*value == 1);
+    }
+    CHECK(AllocationAudit::violations() == violations + 1);
+    CHECK(AllocationAudit::allocations() >= 1);
+
+    tickPathTest();
+}
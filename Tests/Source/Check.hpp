@@ -0,0 +1,37 @@
+#ifndef CHECK_HPP
+#define CHECK_HPP
+
+#include <cmath>
+#include <iostream>
+
+// Failed checks are counted and reported, main returns non-zero when there were any.
+inline int& checkFailures() {
+    static int failures = 0;
+    return failures;
+}
+
+#define CHECK(condition) \
+    do { \
+        if (!(condition)) { \
+            std::cerr << __FILE__ << ":" << __LINE__ << ": check failed: " #condition << std::endl; \
+            checkFailures() += 1; \
+        } \
+    } while (0)
+
+#define CHECK_NEAR(actual, expected, tolerance) \
+    do { \
+        double actualValue = (actual); \
+        double expectedValue = (expected); \
+        if (!(std::abs(actualValue - expectedValue) <= (tolerance))) { \
+            std::cerr << __FILE__ << ":" << __LINE__ << ": " #actual " is " << actualValue \
+                      << ", expected " << expectedValue << std::endl; \
+            checkFailures() += 1; \
+        } \
+    } while (0)
+
+void indicatorsTest();
+void allocationAuditTest();
+void priceSpoolTest();
+void marketStateTest();
+
+#endif // CHECK_HPP
@@ -0,0 +1,115 @@
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+#include "Check.hpp"
+#include "Core/Market/Indicators.hpp"
+
+namespace {
+    // Batch references, recomputed from every sample so far. Missing samples are skipped like the engine does.
+    double referenceSma(const std::vector<double>& prices) {
+        if (prices.size() < SMA_PERIOD) return MISSING_PRICE;
+        double sum = 0;
+        for (size_t i = prices.size() - SMA_PERIOD; i < prices.size(); i += 1) sum += prices[i];
+        return sum / SMA_PERIOD;
+    }
+
+    // two passes over the window, population deviation
+    double referenceDeviation(const std::vector<double>& prices) {
+        double mean = referenceSma(prices);
+        double squares = 0;
+        for (size_t i = prices.size() - SMA_PERIOD; i < prices.size(); i += 1) {
+            squares += (prices[i] - mean) * (prices[i] - mean);
+        }
+        return std::sqrt(squares / SMA_PERIOD);
+    }
+
+    double referenceEma(const std::vector<double>& prices) {
+        if (prices.size() < EMA_PERIOD) return MISSING_PRICE;
+        double ema = 0;
+        for (int i = 0; i < EMA_PERIOD; i += 1) ema += prices[i];
+        ema /= EMA_PERIOD;
+        double alpha = 2.0 / (EMA_PERIOD + 1);
+        for (size_t i = EMA_PERIOD; i < prices.size(); i += 1) {
+            ema = alpha * prices[i] + (1 - alpha) * ema;
+        }
+        return ema;
+    }
+
+    double referenceRsi(const std::vector<double>& prices) {
+        if (prices.size() < RSI_PERIOD + 1) return MISSING_PRICE;
+        double gain = 0, loss = 0;
+        for (int i = 1; i <= RSI_PERIOD; i += 1) {
+            double change = prices[i] - prices[i - 1];
+            gain += std::max(change, 0.0);
+            loss += std::max(-change, 0.0);
+        }
+        gain /= RSI_PERIOD;
+        loss /= RSI_PERIOD;
+        for (size_t i = RSI_PERIOD + 1; i < prices.size(); i += 1) {
+            double change = prices[i] - prices[i - 1];
+            gain = (gain * (RSI_PERIOD - 1) + std::max(change, 0.0)) / RSI_PERIOD;
+            loss = (loss * (RSI_PERIOD - 1) + std::max(-change, 0.0)) / RSI_PERIOD;
+        }
+        if (loss == 0) return gain == 0 ? 50 : 100;
+        return 100 - 100 / (1 + gain / loss);
+    }
+
+    void checkSeries(const std::vector<double>& series) {
+        IndicatorEngine engine;
+        std::vector<double> seen;
+        for (double price : series) {
+            IndicatorValues values = engine.update(price);
+            if (price == MISSING_PRICE) {
+                CHECK(values.sma == MISSING_PRICE && values.ema == MISSING_PRICE && values.rsi == MISSING_PRICE &&
+                      values.upperBand == MISSING_PRICE && values.lowerBand == MISSING_PRICE);
+                continue;
+            }
+            seen.push_back(price);
+
+            // relative to the price level, the engine runs incrementally
+            double tolerance = 1e-9 * std::max(1.0, price);
+            double sma = referenceSma(seen);
+            CHECK_NEAR(values.sma, sma, tolerance);
+            CHECK_NEAR(values.ema, referenceEma(seen), tolerance);
+            CHECK_NEAR(values.rsi, referenceRsi(seen), 1e-6);
+            if (sma != MISSING_PRICE) {
+                double deviation = referenceDeviation(seen);
+                CHECK(!std::isnan(values.upperBand) && !std::isnan(values.lowerBand));
+                // cent moves at 1e5 have a spread of a few cents, it must come out to well below one
+                CHECK_NEAR(values.upperBand - values.sma, BOLLINGER_WIDTH * deviation, 1e-7);
+                CHECK_NEAR(values.sma - values.lowerBand, BOLLINGER_WIDTH * deviation, 1e-7);
+            } else {
+                CHECK(values.upperBand == MISSING_PRICE && values.lowerBand == MISSING_PRICE);
+            }
+        }
+    }
+}
+
+void indicatorsTest() {
+    std::mt19937 random(7);
+    std::normal_distribution<double> step(0.0, 0.0002);
+    std::uniform_int_distribution<int> gap(0, 9);
+
+    // a small stock, and BTC around 1e5 moving by cents, where a sum of squares cancels
+    for (double start : {12.5, 100000.0}) {
+        std::vector<double> series;
+        double price = start;
+        for (int i = 0; i < 2000; i += 1) {
+            if (gap(random) == 0) {
+                series.push_back(MISSING_PRICE);
+                continue;
+            }
+            price = std::round(price * (1.0 + step(random)) * 100) / 100;
+            series.push_back(price);
+        }
+        checkSeries(series);
+    }
+
+    // flat prices have no spread at all, the bands must meet the average instead of going NaN
+    checkSeries(std::vector<double>(100, 100000.01));
+
+    // gaps before the windows are full only delay them
+    checkSeries({MISSING_PRICE, 1, MISSING_PRICE, 2, 3, MISSING_PRICE, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18,
+                 MISSING_PRICE, 19, 20, 21, 22});
+}
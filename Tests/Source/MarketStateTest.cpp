@@ -0,0 +1,181 @@
+#include <algorithm>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+#include "Check.hpp"
+#include "Core/Market/MarketState.hpp"
+
+namespace {
+    constexpr int CHART_LENGTH = 64;   // the panel width
+    constexpr size_t SYMBOLS = 40;
+
+    // What every symbol must show, kept beside the market state: hot symbols take
+    // every trade, the others only at a flush or when they come up on screen.
+    struct Expected {
+        std::string apiSymbol;
+        double price = MISSING_PRICE;
+        double pending = MISSING_PRICE;
+        bool hot = true;
+    };
+
+    void checkSnapshot(const MarketSnapshot& snapshot, const std::vector<Expected>& expected) {
+        CHECK(snapshot.symbols.size() == expected.size());
+        if (snapshot.symbols.size() != expected.size()) return;
+
+        size_t hot = 0;
+        for (size_t i = 0; i < expected.size(); i += 1) {
+            CHECK(snapshot.symbols[i].apiName == expected[i].apiSymbol);
+            CHECK(snapshot.symbols[i].price == expected[i].price);
+            CHECK(snapshot.symbols[i].hot == expected[i].hot);
+            if (expected[i].hot) hot += 1;
+        }
+        if (hot == expected.size()) return;
+
+        CHECK(snapshot.hot.size() == hot);
+        for (size_t i : snapshot.hot) {
+            CHECK(i < expected.size() && expected[i].hot);
+        }
+    }
+
+    std::vector<std::string> apiSymbols(const std::vector<Expected>& expected) {
+        std::vector<std::string> names;
+        for (const auto& symbol : expected) {
+            names.push_back(symbol.apiSymbol);
+        }
+        return names;
+    }
+
+    // Snapshots are held for a while like the render and scene threads do, so the pooled
+    // ones catch up over short and long runs of changes, longer than the change log too.
+    void snapshotTest() {
+        std::mt19937 random(11);
+        MarketState market(CHART_LENGTH);
+
+        std::vector<Expected> expected(SYMBOLS);
+        for (size_t i = 0; i < SYMBOLS; i += 1) {
+            expected[i].apiSymbol = "SYM" + std::to_string(i);
+        }
+        market.setSymbols(apiSymbols(expected), apiSymbols(expected), {});
+
+        std::vector<std::shared_ptr<const MarketSnapshot>> held;
+        size_t first = 0;
+        for (int step = 0; step < 20000; step += 1) {
+            int action = std::uniform_int_distribution<int>(0, 99)(random);
+            if (action < 80) {
+                size_t i = std::uniform_int_distribution<size_t>(0, expected.size() - 1)(random);
+                double price = std::uniform_int_distribution<int>(1, 500)(random) / 4.0;
+                market.updatePrice(expected[i].apiSymbol, price, 0);
+                (expected[i].hot ? expected[i].price : expected[i].pending) = price;
+            } else if (action < 90) {
+                // the symbol on screen and the next two
+                first = (first + 1) % expected.size();
+                std::vector<std::string> hot;
+                for (size_t i = 0; i < 3; i += 1) {
+                    hot.push_back(expected[(first + i) % expected.size()].apiSymbol);
+                }
+                market.setHotSymbols(hot);
+                for (auto& symbol : expected) {
+                    symbol.hot = std::find(hot.begin(), hot.end(), symbol.apiSymbol) != hot.end();
+                    if (symbol.hot && symbol.pending != MISSING_PRICE) {
+                        symbol.price = symbol.pending;
+                        symbol.pending = MISSING_PRICE;
+                    }
+                }
+            } else if (action < 93) {
+                market.flushPrices();
+                for (auto& symbol : expected) {
+                    if (symbol.pending != MISSING_PRICE) symbol.price = symbol.pending;
+                    symbol.pending = MISSING_PRICE;
+                }
+            } else if (action < 94) {
+                // a burst of trades longer than the change log
+                for (int i = 0; i < 1500; i += 1) {
+                    size_t symbol = (first + i % 3) % expected.size();
+                    market.updatePrice(expected[symbol].apiSymbol, 1000 + i, 0);
+                    (expected[symbol].hot ? expected[symbol].price : expected[symbol].pending) = 1000 + i;
+                }
+            } else if (action < 95) {
+                // the watchlist changes, kept symbols keep their prices but move
+                std::shuffle(expected.begin(), expected.end(), random);
+                expected.pop_back();
+                expected.push_back(Expected{"NEW" + std::to_string(step)});
+                market.setSymbols(apiSymbols(expected), apiSymbols(expected), {});
+                // the hot set is looked up by name again, the new symbol is cold
+                std::vector<std::string> hot;
+                for (size_t i = 0; i < 3; i += 1) {
+                    hot.push_back(expected[(first + i) % expected.size()].apiSymbol);
+                }
+                market.setHotSymbols(hot);
+                for (auto& symbol : expected) {
+                    symbol.hot = std::find(hot.begin(), hot.end(), symbol.apiSymbol) != hot.end();
+                    if (symbol.hot && symbol.pending != MISSING_PRICE) {
+                        symbol.price = symbol.pending;
+                        symbol.pending = MISSING_PRICE;
+                    }
+                }
+            }
+
+            auto snapshot = market.snapshot();
+            checkSnapshot(*snapshot, expected);
+            if (checkFailures() > 0) return;
+
+            if (std::uniform_int_distribution<int>(0, 3)(random) == 0) {
+                held.push_back(snapshot);
+            }
+            if (held.size() > 3 || (!held.empty() && std::uniform_int_distribution<int>(0, 2)(random) == 0)) {
+                held.erase(held.begin() + std::uniform_int_distribution<size_t>(0, held.size() - 1)(random));
+            }
+        }
+    }
+
+    // Loads come hot symbols first, then the never loaded ones in watchlist order, a bounded
+    // number per call. Loaded charts found stale in the moving window are loaded again.
+    void historyLoadsTest() {
+        MarketState market(CHART_LENGTH);
+        std::vector<std::string> symbols;
+        for (size_t i = 0; i < 100; i += 1) {
+            symbols.push_back("SYM" + std::to_string(i));
+        }
+        market.setSymbols(symbols, symbols, {});
+        market.setHotSymbols({"SYM50", "SYM51"});
+
+        std::string stale;
+        auto isStale = [&stale](const SymbolSnapshot& symbol) { return symbol.apiName == stale; };
+
+        auto loads = market.historyLoads(8, 16, isStale);
+        CHECK((loads == std::vector<std::string>{"SYM50", "SYM51", "SYM0", "SYM1", "SYM2", "SYM3", "SYM4", "SYM5"}));
+
+        // a failed load is offered again
+        loads = market.historyLoads(8, 16, isStale);
+        CHECK(loads.size() == 8 && loads[0] == "SYM50" && loads[2] == "SYM0");
+
+        size_t loaded = 0;
+        for (int call = 0; call < 20; call += 1) {
+            for (const auto& apiSymbol : market.historyLoads(8, 16, isStale)) {
+                market.setHistory(apiSymbol, {1, 2, 3}, 3, 1);
+                loaded += 1;
+            }
+        }
+        CHECK(loaded == symbols.size());
+        CHECK(market.historyLoads(8, 16, isStale).empty());
+
+        // found within a full turn of the window
+        stale = "SYM77";
+        bool found = false;
+        for (size_t call = 0; call <= symbols.size() / 16 && !found; call += 1) {
+            auto reloads = market.historyLoads(8, 16, isStale);
+            found = reloads == std::vector<std::string>{"SYM77"};
+        }
+        CHECK(found);
+
+        // charts cleared after missed samples are queued again
+        market.clearHistory();
+        CHECK(market.historyLoads(8, 16, isStale).size() == 8);
+    }
+}
+
+void marketStateTest() {
+    snapshotTest();
+    historyLoadsTest();
+}
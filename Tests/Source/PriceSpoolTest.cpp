@@ -0,0 +1,61 @@
+#include <filesystem>
+#include <string>
+#include <vector>
+#include "Check.hpp"
+#include "Core/Database/PriceSpool.hpp"
+
+namespace fs = std::filesystem;
+
+namespace {
+    std::vector<uint64_t> sequences(PriceSpool& spool) {
+        std::vector<uint64_t> result;
+        for (const auto& record : spool.pending(100)) {
+            result.push_back(record.sequence);
+        }
+        return result;
+    }
+}
+
+// The database already holds sequence 100 while the spool file is gone, as
+// after a start in a new working directory or a corrupt file.
+void priceSpoolTest() {
+    fs::path directory = fs::temp_directory_path() / "ticker-spool-test";
+    fs::remove_all(directory);
+    fs::create_directories(directory);
+    std::string fileName = (directory / "prices.spool").string();
+
+    {
+        // the database is down at boot, prices are numbered before its sequence is known
+        PriceSpool spool(fileName);
+        spool.append({{"AAPL", 1.5}, {"MSFT", 2.5}}, 1000);
+    }
+    {
+        PriceSpool spool(fileName);
+        spool.append({{"AAPL", 1.6}}, 2000);
+        CHECK(spool.resume(100));
+        CHECK((sequences(spool) == std::vector<uint64_t>{101, 102, 103}));
+        spool.append({{"AAPL", 1.7}}, 3000);
+        CHECK((sequences(spool) == std::vector<uint64_t>{101, 102, 103, 104}));
+    }
+    {
+        // renumbered on disk, the next connection only skips what reached the database
+        PriceSpool spool(fileName);
+        CHECK(spool.resume(102));
+        CHECK((sequences(spool) == std::vector<uint64_t>{103, 104}));
+        CHECK(spool.lastTime() == 3000);
+        spool.acknowledge(104);
+        CHECK(spool.backlog() == 0);
+        spool.append({{"MSFT", 2.6}}, 4000);
+        CHECK((sequences(spool) == std::vector<uint64_t>{105}));
+    }
+
+    fs::remove(fileName);
+    {
+        PriceSpool spool(fileName);
+        spool.append({{"AAPL", 1.8}}, 5000);
+        CHECK(spool.resume(105));
+        CHECK((sequences(spool) == std::vector<uint64_t>{106}));
+    }
+
+    fs::remove_all(directory);
+}
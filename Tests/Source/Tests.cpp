@@ -0,0 +1,16 @@
+#include <iostream>
+#include "Check.hpp"
+
+int main(int argc, const char * argv[]) {
+    indicatorsTest();
+    allocationAuditTest();
+    priceSpoolTest();
+    marketStateTest();
+
+    if (checkFailures() > 0) {
+        std::cerr << checkFailures() << " checks failed" << std::endl;
+        return 1;
+    }
+    std::cout << "All checks passed" << std::endl;
+    return 0;
+}